@@ -0,0 +1,81 @@
+QT += core gui widgets sql concurrent
+
+CONFIG += c++17
+
+TARGET = CourseProject
+TEMPLATE = app
+
+DESTDIR = $$OUT_PWD/../bin
+
+include(../core.pri)
+
+SOURCES += \
+    ../src/main.cpp \
+    ../src/db/AsyncDatabase.cpp \
+    ../src/db/ConnectionPool.cpp \
+    ../src/db/DatabaseManager.cpp \
+    ../src/db/ProgressCache.cpp \
+    ../src/db/ProgressWriter.cpp \
+    ../src/db/ReportGenerator.cpp \
+    ../src/db/SchemaMigrator.cpp \
+    ../src/db/UserImport.cpp \
+    ../src/db/UsersTableModel.cpp \
+    ../src/ui/LoginDialog.cpp \
+    ../src/ui/AdminWindow.cpp \
+    ../src/ui/StudentWindow.cpp
+
+HEADERS += \
+    ../src/db/AsyncDatabase.h \
+    ../src/db/ConnectionPool.h \
+    ../src/db/DatabaseManager.h \
+    ../src/db/ProgressCache.h \
+    ../src/db/ProgressWriter.h \
+    ../src/db/ReportGenerator.h \
+    ../src/db/SchemaMigrator.h \
+    ../src/db/UserImport.h \
+    ../src/db/UsersTableModel.h \
+    ../src/ui/LoginDialog.h \
+    ../src/ui/AdminWindow.h \
+    ../src/ui/StudentWindow.h
+
+unix {
+    PKGCONFIG += libpq
+}
+
+RESOURCES += \
+    ../resources.qrc
+
+# Компиляция курса при сборке: coursec превращает JSON в course.bin,
+# а rcc встраивает его без сжатия, чтобы QFile::map() мог отобразить
+# ресурс напрямую (см. AppSettings::EMBEDDED_COURSE_PATH)
+COURSEC = $$OUT_PWD/../bin/coursec
+win32: COURSEC = $${COURSEC}.exe
+
+COURSE_SOURCES = $$PWD/../data/course_source.json
+COURSE_GENERATED_DIR = $$OUT_PWD/generated
+
+course_bin.input = COURSE_SOURCES
+course_bin.output = $$COURSE_GENERATED_DIR/course.bin
+course_bin.commands = $$shell_path($$COURSEC) compile ${QMAKE_FILE_IN} ${QMAKE_FILE_OUT}
+course_bin.depends = $$COURSEC
+course_bin.variable_out = COURSE_BINARIES
+course_bin.CONFIG += no_link target_predeps
+QMAKE_EXTRA_COMPILERS += course_bin
+
+# qrc создаётся при запуске qmake рядом с будущим course.bin
+COURSE_QRC = $$COURSE_GENERATED_DIR/course_bin.qrc
+COURSE_QRC_CONTENT = \
+    "<!DOCTYPE RCC>" \
+    "<RCC version=\"1.0\">" \
+    "<qresource prefix=\"/\">" \
+    "    <file>course.bin</file>" \
+    "</qresource>" \
+    "</RCC>"
+write_file($$COURSE_QRC, COURSE_QRC_CONTENT)|error("Cannot write $$COURSE_QRC")
+
+course_rcc.input = COURSE_QRC
+course_rcc.output = $$COURSE_GENERATED_DIR/qrc_course_bin.cpp
+course_rcc.commands = $$shell_path($$[QT_HOST_BINS]/rcc) -name course_bin -no-compress ${QMAKE_FILE_IN} -o ${QMAKE_FILE_OUT}
+course_rcc.depends = $$COURSE_GENERATED_DIR/course.bin
+course_rcc.variable_out = SOURCES
+QMAKE_EXTRA_COMPILERS += course_rcc
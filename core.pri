@@ -0,0 +1,49 @@
+# Ядро работы с курсом: общее для приложения и консольного coursec
+
+QT += core concurrent
+
+CONFIG += c++17
+
+INCLUDEPATH += $$PWD/src
+
+SOURCES += \
+    $$PWD/src/core/CryptoUtils.cpp \
+    $$PWD/src/core/Checksum.cpp \
+    $$PWD/src/core/CourseFormat.cpp \
+    $$PWD/src/core/CourseJsonReader.cpp \
+    $$PWD/src/core/CourseWriter.cpp \
+    $$PWD/src/core/CourseManager.cpp \
+    $$PWD/src/core/CourseView.cpp \
+    $$PWD/src/core/CourseVerifier.cpp \
+    $$PWD/src/core/CourseJournal.cpp \
+    $$PWD/src/core/CourseCache.cpp \
+    $$PWD/src/core/CourseBenchmark.cpp
+
+HEADERS += \
+    $$PWD/src/core/AppSettings.h \
+    $$PWD/src/models/Structures.h \
+    $$PWD/src/core/CryptoUtils.h \
+    $$PWD/src/core/Checksum.h \
+    $$PWD/src/core/CourseFormat.h \
+    $$PWD/src/core/CourseJsonReader.h \
+    $$PWD/src/core/BoundedQueue.h \
+    $$PWD/src/core/CourseWriter.h \
+    $$PWD/src/core/CourseManager.h \
+    $$PWD/src/core/CourseView.h \
+    $$PWD/src/core/CourseVerifier.h \
+    $$PWD/src/core/CourseJournal.h \
+    $$PWD/src/core/CourseCache.h \
+    $$PWD/src/core/CourseBenchmark.h
+
+unix {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += liblz4 libcrypto
+}
+
+win32 {
+    LIBS += -lpsapi -llz4 -lcrypto
+}
+
+CONFIG(debug, debug|release) {
+    DEFINES += DEBUG
+}
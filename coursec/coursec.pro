@@ -0,0 +1,14 @@
+QT -= gui
+
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = coursec
+TEMPLATE = app
+
+DESTDIR = $$OUT_PWD/../bin
+
+include(../core.pri)
+
+SOURCES += \
+    ../src/coursec/main.cpp
@@ -1,5 +1,5 @@
--- Database schema for HTTP Proxy Learning System
--- Created: 2025-12-15
+-- Initial schema for HTTP Proxy Learning System
+-- IF NOT EXISTS lets databases created before migrations adopt this version
 
 -- Users table for authentication and user management
 CREATE TABLE IF NOT EXISTS users (
@@ -21,12 +21,12 @@ CREATE TABLE IF NOT EXISTS study_progress (
     FOREIGN KEY (user_id) REFERENCES users(id) ON DELETE CASCADE
 );
 
--- Create indexes for better performance
 CREATE INDEX IF NOT EXISTS idx_users_login ON users(login);
 CREATE INDEX IF NOT EXISTS idx_study_progress_user_id ON study_progress(user_id);
 CREATE INDEX IF NOT EXISTS idx_study_progress_chapter_id ON study_progress(chapter_id);
 
--- Insert default admin user (password: admin123)
-INSERT INTO users (login, password_hash, role) 
-VALUES ('admin', '$2b$12$LQv3c1yqBWVHxkd0LHAkCOYz6TtxMQJqhN8/LewdBPj/RK.PZvO.G', 'admin')
-ON CONFLICT (login) DO NOTHING;
\ No newline at end of file
+-- Default admin user (password: admin). Legacy SHA-256 hash, replaced
+-- with PBKDF2 on first login
+INSERT INTO users (login, password_hash, role)
+VALUES ('admin', '8c6976e5b5410415bde908bd4dee15dfb167a9c873fc4bb8a81f6f2ab448a918', 'admin')
+ON CONFLICT (login) DO NOTHING;
@@ -0,0 +1,14 @@
+-- Keyset pagination of the admin users table (ORDER BY <column>, id)
+CREATE INDEX IF NOT EXISTS idx_users_role_id ON users(role, id);
+CREATE INDEX IF NOT EXISTS idx_users_created_at_id ON users((COALESCE(created_at, TIMESTAMP 'epoch')), id);
+
+-- Substring login search (ILIKE '%text%'). Search still works without
+-- pg_trgm, only with a sequential scan, so a missing extension is not fatal
+DO $$
+BEGIN
+    CREATE EXTENSION IF NOT EXISTS pg_trgm;
+    CREATE INDEX IF NOT EXISTS idx_users_login_trgm ON users USING gin (login gin_trgm_ops);
+EXCEPTION WHEN OTHERS THEN
+    RAISE WARNING 'pg_trgm is not available, login search will not use an index: %', SQLERRM;
+END
+$$;
@@ -0,0 +1,60 @@
+-- Per-student progress summary for reports, maintained by a trigger on
+-- study_progress so reports read one row per student instead of aggregating
+-- every progress row
+CREATE TABLE IF NOT EXISTS student_progress_summary (
+    user_id INTEGER PRIMARY KEY REFERENCES users(id) ON DELETE CASCADE,
+    completed_chapters INTEGER NOT NULL DEFAULT 0,
+    failed_chapters INTEGER NOT NULL DEFAULT 0,
+    fail_attempts INTEGER NOT NULL DEFAULT 0,
+    last_activity TIMESTAMP
+);
+
+CREATE OR REPLACE FUNCTION study_progress_summary_apply() RETURNS trigger AS $$
+DECLARE
+    completed_delta INTEGER := 0;
+    failed_delta INTEGER := 0;
+BEGIN
+    -- The old row's status no longer counts
+    IF TG_OP <> 'INSERT' THEN
+        completed_delta := completed_delta - (OLD.status = 'completed')::int;
+        failed_delta := failed_delta - (OLD.status = 'fail')::int;
+    END IF;
+    IF TG_OP = 'DELETE' THEN
+        UPDATE student_progress_summary
+        SET completed_chapters = completed_chapters + completed_delta,
+            failed_chapters = failed_chapters + failed_delta
+        WHERE user_id = OLD.user_id;
+        RETURN OLD;
+    END IF;
+
+    completed_delta := completed_delta + (NEW.status = 'completed')::int;
+    failed_delta := failed_delta + (NEW.status = 'fail')::int;
+    INSERT INTO student_progress_summary AS s
+        (user_id, completed_chapters, failed_chapters, fail_attempts, last_activity)
+    VALUES (NEW.user_id, completed_delta, failed_delta, (NEW.status = 'fail')::int, NEW.updated_at)
+    ON CONFLICT (user_id) DO UPDATE SET
+        completed_chapters = s.completed_chapters + EXCLUDED.completed_chapters,
+        failed_chapters = s.failed_chapters + EXCLUDED.failed_chapters,
+        fail_attempts = s.fail_attempts + EXCLUDED.fail_attempts,
+        last_activity = GREATEST(s.last_activity, EXCLUDED.last_activity);
+    RETURN NEW;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS study_progress_summary_trigger ON study_progress;
+CREATE TRIGGER study_progress_summary_trigger
+AFTER INSERT OR UPDATE OR DELETE ON study_progress
+FOR EACH ROW EXECUTE FUNCTION study_progress_summary_apply();
+
+-- One-time backfill of progress recorded before the summary existed
+INSERT INTO student_progress_summary
+    (user_id, completed_chapters, failed_chapters, fail_attempts, last_activity)
+SELECT user_id,
+       COUNT(*) FILTER (WHERE status = 'completed'),
+       COUNT(*) FILTER (WHERE status = 'fail'),
+       COUNT(*) FILTER (WHERE status = 'fail'),
+       MAX(updated_at)
+FROM study_progress
+WHERE NOT EXISTS (SELECT 1 FROM student_progress_summary)
+GROUP BY user_id
+ON CONFLICT (user_id) DO NOTHING;
@@ -0,0 +1,41 @@
+-- Count every failed attempt. The write-behind queue coalesces repeated
+-- saves of a chapter, so the number of failures since the last save is
+-- sent with the row and accumulated in fail_count; the summary adds the
+-- fail_count delta instead of one per written 'fail' row
+ALTER TABLE study_progress ADD COLUMN IF NOT EXISTS fail_count INTEGER NOT NULL DEFAULT 0;
+
+CREATE OR REPLACE FUNCTION study_progress_summary_apply() RETURNS trigger AS $$
+DECLARE
+    completed_delta INTEGER := 0;
+    failed_delta INTEGER := 0;
+    attempts_delta INTEGER := 0;
+BEGIN
+    -- The old row's status no longer counts
+    IF TG_OP <> 'INSERT' THEN
+        completed_delta := completed_delta - (OLD.status = 'completed')::int;
+        failed_delta := failed_delta - (OLD.status = 'fail')::int;
+        attempts_delta := -OLD.fail_count;
+    END IF;
+    IF TG_OP = 'DELETE' THEN
+        -- Attempts are history and stay counted after the row is removed
+        UPDATE student_progress_summary
+        SET completed_chapters = completed_chapters + completed_delta,
+            failed_chapters = failed_chapters + failed_delta
+        WHERE user_id = OLD.user_id;
+        RETURN OLD;
+    END IF;
+
+    completed_delta := completed_delta + (NEW.status = 'completed')::int;
+    failed_delta := failed_delta + (NEW.status = 'fail')::int;
+    attempts_delta := attempts_delta + NEW.fail_count;
+    INSERT INTO student_progress_summary AS s
+        (user_id, completed_chapters, failed_chapters, fail_attempts, last_activity)
+    VALUES (NEW.user_id, completed_delta, failed_delta, attempts_delta, NEW.updated_at)
+    ON CONFLICT (user_id) DO UPDATE SET
+        completed_chapters = s.completed_chapters + EXCLUDED.completed_chapters,
+        failed_chapters = s.failed_chapters + EXCLUDED.failed_chapters,
+        fail_attempts = s.fail_attempts + EXCLUDED.fail_attempts,
+        last_activity = GREATEST(s.last_activity, EXCLUDED.last_activity);
+    RETURN NEW;
+END;
+$$ LANGUAGE plpgsql;
@@ -1,38 +1,53 @@
-#ifndef APPSETTINGS_H
-#define APPSETTINGS_H
-
-#include <QString>
-#include <QStandardPaths>
-#include <QDir>
-#include <QDebug>
-
-namespace AppSettings {
-
-// Ключ шифрования для файла курса
-const QString ENCRYPTION_KEY = "SECRET_KEY_123";
-
-/**
-* @brief Возвращает полный, унифицированный путь к файлу course.bin.
-* Файл располагается в системном каталоге для данных приложения.
-* Эта функция - единственный источник пути к файлу в приложении.
-* @return QString с абсолютным путем к course.bin
-*/
-inline QString getCourseBinaryPath() {
-    // Получаем платформо-независимый путь к каталогу данных приложения
-    QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-    QDir dataDir(dataPath);
-
-    // Гарантируем, что каталог существует. Хотя main() его уже создает,
-    // эта проверка обеспечивает дополнительную надежность.
-    if (!dataDir.exists()) {
-        qWarning() << "AppDataLocation directory does not exist, creating:" << dataPath;
-        if (!dataDir.mkpath(".")) {
-            qCritical() << "Failed to create AppDataLocation directory!";
-        }
-    }
-    return dataDir.filePath("course.bin");
-}
-
-} // namespace AppSettings
-
-#endif // APPSETTINGS_H
+#ifndef APPSETTINGS_H
+#define APPSETTINGS_H
+
+#include <QString>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFile>
+#include <QDebug>
+
+namespace AppSettings {
+
+// Ключ шифрования для файла курса
+const QString ENCRYPTION_KEY = "SECRET_KEY_123";
+
+// Курс, скомпилированный при сборке (coursec) и встроенный в ресурсы без сжатия
+const QString EMBEDDED_COURSE_PATH = ":/course.bin";
+
+/**
+* @brief Возвращает полный, унифицированный путь к файлу course.bin.
+* Файл располагается в системном каталоге для данных приложения.
+* Эта функция - единственный источник пути к файлу в приложении.
+* @return QString с абсолютным путем к course.bin
+*/
+inline QString getCourseBinaryPath() {
+    // Получаем платформо-независимый путь к каталогу данных приложения
+    QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir dataDir(dataPath);
+
+    // Гарантируем, что каталог существует. Хотя main() его уже создает,
+    // эта проверка обеспечивает дополнительную надежность.
+    if (!dataDir.exists()) {
+        qWarning() << "AppDataLocation directory does not exist, creating:" << dataPath;
+        if (!dataDir.mkpath(".")) {
+            qCritical() << "Failed to create AppDataLocation directory!";
+        }
+    }
+    return dataDir.filePath("course.bin");
+}
+
+/**
+* @brief Возвращает путь к файлу курса для чтения.
+* Копия, сохранённая редактором администратора в AppDataLocation, имеет
+* приоритет; пока её нет, курс читается прямо из встроенного ресурса.
+* @return QString с путем к course.bin или EMBEDDED_COURSE_PATH
+*/
+inline QString getCourseReadPath() {
+    const QString binaryPath = getCourseBinaryPath();
+    return QFile::exists(binaryPath) ? binaryPath : EMBEDDED_COURSE_PATH;
+}
+
+} // namespace AppSettings
+
+#endif // APPSETTINGS_H
@@ -0,0 +1,98 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <QMutex>
+#include <QPair>
+#include <QQueue>
+#include <QWaitCondition>
+
+/**
+ * @brief Очередь между потоками с ограничением суммарного объёма.
+ * Производитель блокируется, пока объём элементов в очереди превышает
+ * ёмкость, поэтому память не растёт, если потребитель (например, запись
+ * на диск) медленнее производителя. Элемент больше ёмкости принимается
+ * только в пустую очередь.
+ */
+template <typename T>
+class BoundedQueue
+{
+public:
+    /**
+     * @param capacity Максимальный суммарный объём элементов (например, в байтах)
+     */
+    explicit BoundedQueue(qint64 capacity)
+        : m_capacity(capacity), m_size(0), m_peakSize(0), m_closed(false) {}
+
+    /**
+     * @brief Добавляет элемент, дожидаясь свободного места.
+     * @param item Элемент
+     * @param size Объём элемента
+     * @return false если очередь закрыта
+     */
+    bool push(T item, qint64 size) {
+        QMutexLocker locker(&m_mutex);
+        while (!m_closed && !m_items.isEmpty() && m_size + size > m_capacity) {
+            m_notFull.wait(&m_mutex);
+        }
+        if (m_closed) {
+            return false;
+        }
+
+        m_items.enqueue(qMakePair(std::move(item), size));
+        m_size += size;
+        m_peakSize = qMax(m_peakSize, m_size);
+        m_notEmpty.wakeOne();
+        return true;
+    }
+
+    /**
+     * @brief Извлекает элемент, дожидаясь его появления.
+     * @return false если очередь закрыта и пуста
+     */
+    bool pop(T& item) {
+        QMutexLocker locker(&m_mutex);
+        while (!m_closed && m_items.isEmpty()) {
+            m_notEmpty.wait(&m_mutex);
+        }
+        if (m_items.isEmpty()) {
+            return false;
+        }
+
+        QPair<T, qint64> entry = m_items.dequeue();
+        item = std::move(entry.first);
+        m_size -= entry.second;
+        m_notFull.wakeAll();
+        return true;
+    }
+
+    /**
+     * @brief Закрывает очередь: новые элементы не принимаются,
+     * оставшиеся можно извлечь.
+     */
+    void close() {
+        QMutexLocker locker(&m_mutex);
+        m_closed = true;
+        m_notEmpty.wakeAll();
+        m_notFull.wakeAll();
+    }
+
+    /**
+     * @brief Наибольший объём, одновременно находившийся в очереди.
+     */
+    qint64 peakSize() {
+        QMutexLocker locker(&m_mutex);
+        return m_peakSize;
+    }
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_notFull;
+    QWaitCondition m_notEmpty;
+    QQueue<QPair<T, qint64>> m_items;
+    qint64 m_capacity;
+    qint64 m_size;
+    qint64 m_peakSize;
+    bool m_closed;
+};
+
+#endif // BOUNDEDQUEUE_H
@@ -0,0 +1,124 @@
+#include "Checksum.h"
+#include <cstring>
+
+#if defined(Q_PROCESSOR_X86)
+#include <nmmintrin.h>
+#if defined(Q_CC_MSVC)
+#include <intrin.h>
+#endif
+#elif defined(Q_PROCESSOR_ARM_64) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace {
+
+// Отражённый полином Castagnoli
+const quint32 CRC32C_POLYNOMIAL = 0x82F63B78;
+
+struct Crc32cTable {
+    quint32 values[256];
+
+    Crc32cTable() {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLYNOMIAL : crc >> 1;
+            }
+            values[i] = crc;
+        }
+    }
+};
+
+quint32 crc32cSoftware(const char* data, qint64 size, quint32 crc) {
+    static const Crc32cTable table;
+    const uchar* bytes = reinterpret_cast<const uchar*>(data);
+    for (qint64 i = 0; i < size; ++i) {
+        crc = table.values[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if defined(Q_PROCESSOR_X86)
+
+#if defined(Q_CC_GNU) || defined(Q_CC_CLANG)
+__attribute__((target("sse4.2")))
+#endif
+quint32 crc32cHardware(const char* data, qint64 size, quint32 crc) {
+#if defined(Q_PROCESSOR_X86_64)
+    quint64 crc64 = crc;
+    for (; size >= 8; data += 8, size -= 8) {
+        quint64 word;
+        memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = quint32(crc64);
+#endif
+    for (; size >= 4; data += 4, size -= 4) {
+        quint32 word;
+        memcpy(&word, data, sizeof(word));
+        crc = _mm_crc32_u32(crc, word);
+    }
+    for (; size > 0; ++data, --size) {
+        crc = _mm_crc32_u8(crc, uchar(*data));
+    }
+    return crc;
+}
+
+bool detectHardwareCrc32c() {
+#if defined(Q_CC_MSVC)
+    int info[4] = {0, 0, 0, 0};
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0; // ECX.SSE4_2
+#elif defined(Q_CC_GNU) || defined(Q_CC_CLANG)
+    return __builtin_cpu_supports("sse4.2");
+#else
+    return false;
+#endif
+}
+
+#elif defined(Q_PROCESSOR_ARM_64) && defined(__ARM_FEATURE_CRC32)
+
+quint32 crc32cHardware(const char* data, qint64 size, quint32 crc) {
+    for (; size >= 8; data += 8, size -= 8) {
+        quint64 word;
+        memcpy(&word, data, sizeof(word));
+        crc = __crc32cd(crc, word);
+    }
+    for (; size > 0; ++data, --size) {
+        crc = __crc32cb(crc, uchar(*data));
+    }
+    return crc;
+}
+
+bool detectHardwareCrc32c() {
+    return true; // расширение CRC включено при компиляции
+}
+
+#else
+
+quint32 crc32cHardware(const char* data, qint64 size, quint32 crc) {
+    return crc32cSoftware(data, size, crc);
+}
+
+bool detectHardwareCrc32c() {
+    return false;
+}
+
+#endif
+
+} // namespace
+
+bool Checksum::isHardwareAccelerated() {
+    static const bool hardware = detectHardwareCrc32c();
+    return hardware;
+}
+
+quint32 Checksum::crc32c(const char* data, qint64 size, quint32 crc) {
+    crc = ~crc;
+    crc = isHardwareAccelerated() ? crc32cHardware(data, size, crc) : crc32cSoftware(data, size, crc);
+    return ~crc;
+}
+
+quint32 Checksum::crc32c(const QByteArray& data) {
+    return crc32c(data.constData(), data.size());
+}
@@ -0,0 +1,38 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <QByteArray>
+
+/**
+ * @brief Контрольные суммы для проверки целостности course.bin.
+ * CRC32C (Castagnoli) вычисляется инструкцией crc32 процессора (SSE4.2 на
+ * x86, расширение CRC на ARMv8), если она доступна, иначе табличным способом.
+ * Выбор реализации выполняется один раз во время работы программы.
+ */
+class Checksum
+{
+public:
+    /**
+     * @brief Вычисляет CRC32C блока данных.
+     * @param data Данные
+     * @param size Размер данных в байтах
+     * @param crc Результат для предыдущих блоков, если сумма считается по частям
+     * @return CRC32C
+     */
+    static quint32 crc32c(const char* data, qint64 size, quint32 crc = 0);
+
+    /**
+     * @brief Вычисляет CRC32C массива байт.
+     */
+    static quint32 crc32c(const QByteArray& data);
+
+    /**
+     * @brief Возвращает true, если используется аппаратная реализация.
+     */
+    static bool isHardwareAccelerated();
+
+private:
+    Checksum() = delete;
+};
+
+#endif // CHECKSUM_H
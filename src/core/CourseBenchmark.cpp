@@ -0,0 +1,627 @@
+#include "CourseBenchmark.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QRandomGenerator>
+#include <QCryptographicHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <QThreadPool>
+#include "CourseFormat.h"
+#include "CourseJournal.h"
+#include "CourseManager.h"
+#include "CourseVerifier.h"
+#include "CourseView.h"
+#include "CourseWriter.h"
+#include "CryptoUtils.h"
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif !defined(Q_OS_LINUX)
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+#if defined(Q_OS_LINUX)
+// Читает значение поля вида "VmRSS:   1234 kB" из /proc/self/status
+qint64 readProcStatusKb(const QByteArray& field) {
+    QFile status("/proc/self/status");
+    if (!status.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return -1;
+    }
+
+    while (!status.atEnd()) {
+        const QByteArray line = status.readLine();
+        if (line.startsWith(field)) {
+            const QList<QByteArray> parts = line.mid(field.size()).simplified().split(' ');
+            return parts.isEmpty() ? -1 : parts.first().toLongLong();
+        }
+    }
+    return -1;
+}
+#endif
+
+// Обратное преобразование к CourseJsonReader::chapterFromJson
+QJsonObject chapterToJson(const Chapter& chapter) {
+    QJsonArray questions;
+    for (const Question& question : chapter.questions) {
+        QJsonObject questionObj;
+        questionObj["q_text"] = question.q_text;
+        questionObj["options"] = QJsonArray::fromStringList(question.options);
+        questionObj["correct_index"] = question.correct_index;
+        questions.append(questionObj);
+    }
+
+    QJsonObject chapterObj;
+    chapterObj["id"] = chapter.id;
+    chapterObj["title"] = chapter.title;
+    chapterObj["content"] = chapter.content;
+    chapterObj["questions"] = questions;
+    return chapterObj;
+}
+
+// Прежняя реализация CryptoUtils::xorEncryptDecrypt - точка отсчёта для замера
+QByteArray legacyXor(const QByteArray& data, const QString& key) {
+    QByteArray keyBytes = key.toUtf8();
+    QByteArray result = data;
+    for (int i = 0; i < result.size(); ++i) {
+        result[i] = result[i] ^ keyBytes[i % keyBytes.size()];
+    }
+    return result;
+}
+
+double gigabytesPerSecond(qint64 bytes, qint64 nanoseconds) {
+    return nanoseconds > 0 ? double(bytes) / double(nanoseconds) : 0.0; // байт/нс = ГБ/с
+}
+
+QByteArray fileSha256(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(&file);
+    return hash.result();
+}
+
+} // namespace
+
+qint64 CourseBenchmark::currentRssKb() {
+#if defined(Q_OS_LINUX)
+    return readProcStatusKb("VmRSS:");
+#elif defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return qint64(counters.WorkingSetSize / 1024);
+    }
+    return -1;
+#else
+    return -1;
+#endif
+}
+
+qint64 CourseBenchmark::peakRssKb() {
+#if defined(Q_OS_LINUX)
+    return readProcStatusKb("VmHWM:");
+#elif defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return qint64(counters.PeakWorkingSetSize / 1024);
+    }
+    return -1;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+#if defined(Q_OS_MACOS)
+    return qint64(usage.ru_maxrss / 1024); // на macOS значение в байтах
+#else
+    return qint64(usage.ru_maxrss);
+#endif
+#endif
+}
+
+CourseBenchmark::LoadResult CourseBenchmark::measureViewLoad(const QString& binPath, const QString& key, int iterations) {
+    LoadResult result;
+    QElapsedTimer timer;
+    qint64 totalNs = 0;
+
+    for (int i = 0; i < iterations; ++i) {
+        const qint64 rssBefore = currentRssKb();
+        timer.start();
+
+        CourseView view;
+        if (!view.open(binPath, key)) {
+            qWarning() << "CourseView: cannot open" << binPath;
+            return result;
+        }
+
+        // Всё, что нужно UI для показа первой главы и её теста
+        int touchedChars = view.chapterTitle(0).size() + view.chapterContent(0).size();
+        for (int q = 0; q < view.questionCount(0); ++q) {
+            touchedChars += view.questionText(0, q).size();
+            touchedChars += view.questionOptions(0, q).size();
+        }
+
+        totalNs += timer.nsecsElapsed();
+        if (i == 0) {
+            const qint64 rssAfter = currentRssKb();
+            result.rssDeltaKb = (rssBefore >= 0 && rssAfter >= 0) ? rssAfter - rssBefore : -1;
+            qDebug() << "CourseView touched" << touchedChars << "characters";
+        }
+    }
+
+    result.firstChapterMs = double(totalNs) / iterations / 1e6;
+    result.peakRssKb = peakRssKb();
+    return result;
+}
+
+CourseBenchmark::LoadResult CourseBenchmark::measureCourseLoad(const QString& binPath, const QString& key, int iterations) {
+    LoadResult result;
+    QElapsedTimer timer;
+    qint64 totalNs = 0;
+
+    for (int i = 0; i < iterations; ++i) {
+        const qint64 rssBefore = currentRssKb();
+        timer.start();
+
+        Course course = CourseManager::loadCourseFromBinary(binPath, key);
+        if (course.chapters.isEmpty()) {
+            qWarning() << "Course: cannot load" << binPath;
+            return result;
+        }
+
+        const Chapter& first = course.chapters.first();
+        int touchedChars = first.title.size() + first.content.size();
+        for (const Question& question : first.questions) {
+            touchedChars += question.q_text.size() + question.options.size();
+        }
+
+        totalNs += timer.nsecsElapsed();
+        if (i == 0) {
+            const qint64 rssAfter = currentRssKb();
+            result.rssDeltaKb = (rssBefore >= 0 && rssAfter >= 0) ? rssAfter - rssBefore : -1;
+            qDebug() << "Course touched" << touchedChars << "characters";
+        }
+    }
+
+    result.firstChapterMs = double(totalNs) / iterations / 1e6;
+    result.peakRssKb = peakRssKb();
+    return result;
+}
+
+void CourseBenchmark::compareLoadPaths(const QString& binPath, const QString& key, int iterations) {
+    if (iterations < 1) {
+        iterations = 1;
+    }
+
+    qInfo() << "=== Course load benchmark ===";
+    qInfo() << "File:" << binPath << "size:" << QFileInfo(binPath).size() << "bytes," << iterations << "iterations";
+
+    const LoadResult view = measureViewLoad(binPath, key, iterations);
+    const LoadResult course = measureCourseLoad(binPath, key, iterations);
+
+    qInfo().noquote() << QString("%1 | %2 | %3 | %4")
+                             .arg("Path", -12)
+                             .arg("First chapter, ms", -18)
+                             .arg("RSS delta, KB", -14)
+                             .arg("Peak RSS, KB");
+    qInfo().noquote() << QString("%1 | %2 | %3 | %4")
+                             .arg("CourseView", -12)
+                             .arg(view.firstChapterMs, -18, 'f', 3)
+                             .arg(view.rssDeltaKb, -14)
+                             .arg(view.peakRssKb);
+    qInfo().noquote() << QString("%1 | %2 | %3 | %4")
+                             .arg("Course", -12)
+                             .arg(course.firstChapterMs, -18, 'f', 3)
+                             .arg(course.rssDeltaKb, -14)
+                             .arg(course.peakRssKb);
+}
+
+Course CourseBenchmark::makeSyntheticCourse(int chapterCount, int paragraphsPerChapter) {
+    static const char* const words[] = {
+        "прокси", "сервер", "клиент", "запрос", "ответ", "заголовок", "соединение",
+        "кэширование", "туннель", "CONNECT", "HTTP/1.1", "Host", "порт", "адрес",
+        "фильтрация", "аутентификация", "шифрование", "TLS", "обратный", "прозрачный"
+    };
+    const int wordCount = int(sizeof(words) / sizeof(words[0]));
+
+    QRandomGenerator generator(42);
+    Course course;
+    course.chapters.reserve(chapterCount);
+
+    for (int c = 0; c < chapterCount; ++c) {
+        Chapter chapter(c + 1, QString("Синтетическая глава %1").arg(c + 1), QString());
+
+        QString content;
+        for (int p = 0; p < paragraphsPerChapter; ++p) {
+            content += "<p>";
+            const int length = 40 + int(generator.bounded(40));
+            for (int w = 0; w < length; ++w) {
+                const QString word = QString::fromUtf8(words[generator.bounded(wordCount)]);
+                content += (w % 9 == 0) ? QString("<b>%1</b> ").arg(word) : word + ' ';
+            }
+            content += "</p>";
+        }
+        chapter.content = content;
+
+        for (int q = 0; q < 5; ++q) {
+            chapter.questions.append(Question(
+                QString("Вопрос %1 по главе %2?").arg(q + 1).arg(c + 1),
+                {"Вариант A", "Вариант B", "Вариант C", "Вариант D"},
+                q % 4));
+        }
+        course.chapters.append(chapter);
+    }
+
+    return course;
+}
+
+void CourseBenchmark::compareCodecs(const QString& workDir, const QString& key) {
+    const QList<CourseFormat::Codec> codecs = {
+        CourseFormat::Codec::None, CourseFormat::Codec::Zlib, CourseFormat::Codec::Lz4
+    };
+    const QList<int> chapterCounts = {100, 1000};
+    const int paragraphsPerChapter = 30;
+
+    qInfo() << "=== Course codec benchmark ===";
+    qInfo() << "Work directory:" << workDir;
+    qInfo().noquote() << QString("%1 | %2 | %3 | %4 | %5 | %6")
+                             .arg("Chapters", -8)
+                             .arg("Codec", -5)
+                             .arg("File, KB", -10)
+                             .arg("Write, ms", -10)
+                             .arg("Chapter decode, us", -19)
+                             .arg("Full load, ms");
+
+    for (int chapterCount : chapterCounts) {
+        const Course course = makeSyntheticCourse(chapterCount, paragraphsPerChapter);
+
+        for (CourseFormat::Codec codec : codecs) {
+            const QString binPath = QDir(workDir).filePath(
+                QString("course_bench_%1_%2.bin").arg(chapterCount).arg(CourseFormat::codecName(codec)));
+
+            QElapsedTimer timer;
+            timer.start();
+
+            CourseWriter writer;
+            writer.setCodec(codec);
+            bool written = writer.open(binPath, key);
+            for (int i = 0; written && i < course.chapters.size(); ++i) {
+                written = writer.addChapter(course.chapters[i]);
+            }
+            if (!written || !writer.commit()) {
+                qWarning() << "Cannot write benchmark file" << binPath;
+                writer.cancel();
+                continue;
+            }
+            const qint64 writeMs = timer.elapsed();
+
+            // Декодирование каждой главы по отдельности, как при навигации в UI
+            CourseView view;
+            if (!view.open(binPath, key)) {
+                qWarning() << "Cannot open benchmark file" << binPath;
+                continue;
+            }
+            timer.restart();
+            qint64 touchedChars = 0;
+            for (int i = 0; i < view.chapterCount(); ++i) {
+                touchedChars += view.chapterContent(i).size();
+            }
+            const double chapterDecodeUs = double(timer.nsecsElapsed()) / view.chapterCount() / 1000.0;
+            view.close();
+
+            timer.restart();
+            const Course loaded = CourseManager::loadCourseFromBinary(binPath, key);
+            const qint64 fullLoadMs = timer.elapsed();
+
+            qInfo().noquote() << QString("%1 | %2 | %3 | %4 | %5 | %6")
+                                     .arg(chapterCount, -8)
+                                     .arg(CourseFormat::codecName(codec), -5)
+                                     .arg(QFileInfo(binPath).size() / 1024, -10)
+                                     .arg(writeMs, -10)
+                                     .arg(chapterDecodeUs, -19, 'f', 1)
+                                     .arg(fullLoadMs);
+
+            if (loaded.chapters.size() != chapterCount || touchedChars == 0) {
+                qWarning() << "Benchmark file" << binPath << "did not round-trip";
+            }
+            QFile::remove(binPath);
+        }
+    }
+}
+
+void CourseBenchmark::compareCompileThreads(const QString& workDir, const QString& key, int chapterCount) {
+    const QDir dir(workDir);
+    const QString jsonPath = dir.filePath("course_bench_compile.json");
+    const QString referencePath = dir.filePath("course_bench_compile_reference.bin");
+    const QString binPath = dir.filePath("course_bench_compile.bin");
+
+    const Course course = makeSyntheticCourse(chapterCount, 30);
+    {
+        QJsonArray chapters;
+        for (const Chapter& chapter : course.chapters) {
+            chapters.append(chapterToJson(chapter));
+        }
+        QFile jsonFile(jsonPath);
+        if (!jsonFile.open(QIODevice::WriteOnly)
+            || jsonFile.write(QJsonDocument(chapters).toJson(QJsonDocument::Compact)) < 0) {
+            qWarning() << "Cannot write benchmark JSON" << jsonPath;
+            return;
+        }
+    }
+
+    // Эталон - последовательная запись того же курса
+    if (!CourseManager::saveCourseToBinary(course, referencePath, key)) {
+        qWarning() << "Cannot write reference file" << referencePath;
+        QFile::remove(jsonPath);
+        return;
+    }
+    const QByteArray referenceHash = fileSha256(referencePath);
+
+    QThreadPool* pool = QThreadPool::globalInstance();
+    const int savedMaxThreads = pool->maxThreadCount();
+    const int idealThreads = QThread::idealThreadCount();
+
+    QList<int> threadCounts;
+    for (int threads = 1; threads < idealThreads; threads *= 2) {
+        threadCounts.append(threads);
+    }
+    threadCounts.append(idealThreads);
+
+    qInfo() << "=== Course compile benchmark ===";
+    qInfo() << "Chapters:" << chapterCount << "JSON size:" << QFileInfo(jsonPath).size() / 1024 << "KB";
+    qInfo().noquote() << QString("%1 | %2 | %3 | %4")
+                             .arg("Threads", -7)
+                             .arg("Compile, ms", -12)
+                             .arg("Speedup", -8)
+                             .arg("Identical");
+
+    qint64 singleThreadMs = 0;
+    for (int threads : threadCounts) {
+        pool->setMaxThreadCount(threads);
+
+        QElapsedTimer timer;
+        timer.start();
+        const bool compiled = CourseManager::compileCourseFromJSON(jsonPath, binPath, key);
+        const qint64 elapsedMs = qMax<qint64>(timer.elapsed(), 1);
+        if (!compiled) {
+            qWarning() << "Compilation failed with" << threads << "threads";
+            continue;
+        }
+        if (threads == 1) {
+            singleThreadMs = elapsedMs;
+        }
+
+        qInfo().noquote() << QString("%1 | %2 | %3 | %4")
+                                 .arg(threads, -7)
+                                 .arg(elapsedMs, -12)
+                                 .arg(singleThreadMs > 0 ? double(singleThreadMs) / elapsedMs : 0.0, -8, 'f', 2)
+                                 .arg(fileSha256(binPath) == referenceHash ? "yes" : "NO");
+    }
+
+    pool->setMaxThreadCount(savedMaxThreads);
+    QFile::remove(jsonPath);
+    QFile::remove(referencePath);
+    QFile::remove(binPath);
+}
+
+void CourseBenchmark::compareSavePaths(const QString& workDir, const QString& key, int chapterCount, int iterations) {
+    if (iterations < 1) {
+        iterations = 1;
+    }
+
+    const QString binPath = QDir(workDir).filePath("course_bench_save.bin");
+    Course course = makeSyntheticCourse(chapterCount, 30);
+
+    qInfo() << "=== Course save benchmark ===";
+    qInfo() << "Chapters:" << chapterCount << "iterations:" << iterations;
+
+    QElapsedTimer timer;
+    qint64 fullNs = 0;
+    for (int i = 0; i < iterations; ++i) {
+        timer.start();
+        if (!CourseManager::saveCourseToBinary(course, binPath, key)) {
+            qWarning() << "Cannot write benchmark file" << binPath;
+            return;
+        }
+        fullNs += timer.nsecsElapsed();
+    }
+    const qint64 fullSize = QFileInfo(binPath).size();
+
+    // Журнал дописывает изменённую главу в только что записанный файл
+    qint64 journalNs = 0;
+    {
+        CourseJournal journal(binPath, key);
+        for (int i = 0; i < iterations; ++i) {
+            const int chapterIndex = (i * 7) % course.chapters.size();
+            course.chapters[chapterIndex].content += QString("<p>Правка %1</p>").arg(i);
+
+            timer.start();
+            if (!journal.saveChapter(course, chapterIndex)) {
+                qWarning() << "Journal save failed:" << journal.errorString();
+                QFile::remove(binPath);
+                return;
+            }
+            journalNs += timer.nsecsElapsed();
+        }
+        journal.waitForCompaction();
+    }
+    const qint64 journalSize = QFileInfo(binPath).size();
+
+    qInfo().noquote() << QString("%1 | %2 | %3")
+                             .arg("Path", -14)
+                             .arg("Save, ms", -10)
+                             .arg("File, KB");
+    qInfo().noquote() << QString("%1 | %2 | %3")
+                             .arg("Full rewrite", -14)
+                             .arg(double(fullNs) / iterations / 1e6, -10, 'f', 3)
+                             .arg(fullSize / 1024);
+    qInfo().noquote() << QString("%1 | %2 | %3")
+                             .arg("Journal", -14)
+                             .arg(double(journalNs) / iterations / 1e6, -10, 'f', 3)
+                             .arg(journalSize / 1024);
+
+    QFile::remove(binPath);
+}
+
+void CourseBenchmark::compareXorKernels(const QString& key, int megabytes, int iterations) {
+    if (iterations < 1) {
+        iterations = 1;
+    }
+
+    QByteArray data(qint64(megabytes) * 1024 * 1024, Qt::Uninitialized);
+    QRandomGenerator generator(42);
+    generator.fillRange(reinterpret_cast<quint32*>(data.data()), data.size() / int(sizeof(quint32)));
+
+    const QByteArray reference = legacyXor(data, key);
+    const qint64 totalBytes = data.size() * qint64(iterations);
+
+    qInfo() << "=== XOR throughput benchmark ===";
+    qInfo() << "Buffer:" << megabytes << "MB, key length:" << key.toUtf8().size()
+            << "bytes, selected kernel:" << CryptoUtils::xorKernelName(CryptoUtils::xorKernel());
+    qInfo().noquote() << QString("%1 | %2 | %3")
+                             .arg("Variant", -24)
+                             .arg("GB/s", -8)
+                             .arg("Matches");
+
+    auto report = [&](const QString& name, qint64 nanoseconds, bool matches) {
+        qInfo().noquote() << QString("%1 | %2 | %3")
+                                 .arg(name, -24)
+                                 .arg(gigabytesPerSecond(totalBytes, nanoseconds), -8, 'f', 2)
+                                 .arg(matches ? "yes" : "NO");
+    };
+
+    QElapsedTimer timer;
+    QByteArray result;
+
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        result = legacyXor(data, key);
+    }
+    report("legacy byte loop", timer.nsecsElapsed(), result == reference);
+
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        result = CryptoUtils::xorEncryptDecrypt(data, key);
+    }
+    report("xorEncryptDecrypt (copy)", timer.nsecsElapsed(), result == reference);
+
+    for (CryptoUtils::XorKernel kernel : {CryptoUtils::XorKernel::Scalar, CryptoUtils::XorKernel::Sse2,
+                                          CryptoUtils::XorKernel::Avx2}) {
+        if (!CryptoUtils::isXorKernelSupported(kernel)) {
+            continue;
+        }
+
+        // На месте: чётное число проходов возвращает исходные данные
+        QByteArray buffer = data;
+        buffer.detach();
+        XorKeyStream stream(key);
+        stream.setKernel(kernel);
+
+        timer.start();
+        for (int i = 0; i < iterations; ++i) {
+            stream.seek(0);
+            stream.apply(buffer.data(), buffer.size());
+        }
+        const qint64 elapsed = timer.nsecsElapsed();
+
+        report(QString("in-place %1").arg(CryptoUtils::xorKernelName(kernel)), elapsed,
+               (iterations % 2 == 0) ? buffer == data : buffer == reference);
+    }
+}
+
+void CourseBenchmark::compareCiphers(const QString& workDir, const QString& key, int chapterCount, int iterations) {
+    if (iterations < 1) {
+        iterations = 1;
+    }
+
+    const QList<CourseFormat::Cipher> ciphers = {CourseFormat::Cipher::Xor, CourseFormat::Cipher::AesGcm};
+    const Course course = makeSyntheticCourse(chapterCount, 30);
+
+    // Пропускная способность самих шифров на одном ядре, без сжатия и файлов
+    QByteArray buffer(16 * 1024 * 1024, Qt::Uninitialized);
+    QRandomGenerator generator(42);
+    generator.fillRange(reinterpret_cast<quint32*>(buffer.data()), buffer.size() / int(sizeof(quint32)));
+
+    QElapsedTimer timer;
+    timer.start();
+    const QByteArray xorData = CryptoUtils::xorEncryptDecrypt(buffer, key);
+    const qint64 xorNs = timer.nsecsElapsed();
+
+    const QByteArray sealed = CryptoUtils::aesGcmEncrypt(buffer, key, QByteArray());
+    QByteArray opened;
+    timer.restart();
+    const bool authenticated = CryptoUtils::aesGcmDecrypt(sealed, key, QByteArray(), opened);
+    const qint64 aesNs = timer.nsecsElapsed();
+
+    qInfo() << "=== Course cipher benchmark ===";
+    qInfo() << "Work directory:" << workDir << "," << chapterCount << "chapters,"
+            << QThreadPool::globalInstance()->maxThreadCount() << "threads";
+    qInfo().noquote() << QString("Single thread: xor %1 GB/s, aes-gcm decrypt %2 GB/s%3")
+                             .arg(gigabytesPerSecond(buffer.size(), xorNs), 0, 'f', 2)
+                             .arg(gigabytesPerSecond(buffer.size(), aesNs), 0, 'f', 2)
+                             .arg(authenticated && opened == buffer && !xorData.isEmpty() ? "" : " (ROUND-TRIP FAILED)");
+    qInfo().noquote() << QString("%1 | %2 | %3 | %4 | %5 | %6")
+                             .arg("Cipher", -7)
+                             .arg("File, KB", -10)
+                             .arg("Write, ms", -10)
+                             .arg("First chapter, us", -18)
+                             .arg("Full load, ms", -14)
+                             .arg("Deep verify, ms");
+
+    for (CourseFormat::Cipher cipher : ciphers) {
+        const QString binPath = QDir(workDir).filePath(
+            QString("course_bench_cipher_%1.bin").arg(CourseFormat::cipherName(cipher)));
+
+        timer.restart();
+        if (!CourseManager::saveCourseToBinary(course, binPath, key, CourseFormat::DEFAULT_CODEC, cipher)) {
+            qWarning() << "Cannot write benchmark file" << binPath;
+            continue;
+        }
+        const qint64 writeMs = timer.elapsed();
+
+        // Время до первой главы: открытие файла и чтение текста главы, как в StudentWindow
+        qint64 firstChapterNs = 0;
+        qint64 touchedChars = 0;
+        for (int i = 0; i < iterations; ++i) {
+            timer.restart();
+            CourseView view;
+            if (view.open(binPath, key)) {
+                touchedChars += view.chapterContent(0).size();
+            }
+            firstChapterNs += timer.nsecsElapsed();
+        }
+
+        qint64 fullLoadMs = 0;
+        int loadedChapters = 0;
+        for (int i = 0; i < iterations; ++i) {
+            timer.restart();
+            const Course loaded = CourseManager::loadCourseFromBinary(binPath, key);
+            fullLoadMs += timer.elapsed();
+            loadedChapters = loaded.chapters.size();
+        }
+
+        const CourseVerifier::Report report = CourseVerifier::deepVerify(binPath, key);
+
+        qInfo().noquote() << QString("%1 | %2 | %3 | %4 | %5 | %6")
+                                 .arg(CourseFormat::cipherName(cipher), -7)
+                                 .arg(QFileInfo(binPath).size() / 1024, -10)
+                                 .arg(writeMs, -10)
+                                 .arg(double(firstChapterNs) / iterations / 1000.0, -18, 'f', 1)
+                                 .arg(double(fullLoadMs) / iterations, -14, 'f', 1)
+                                 .arg(report.elapsedMs);
+
+        if (loadedChapters != chapterCount || touchedChars == 0 || !report.isValid()) {
+            qWarning() << "Benchmark file" << binPath << "did not round-trip";
+        }
+        QFile::remove(binPath);
+    }
+}
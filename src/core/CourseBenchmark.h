@@ -0,0 +1,112 @@
+#ifndef COURSEBENCHMARK_H
+#define COURSEBENCHMARK_H
+
+#include <QString>
+#include "models/Structures.h"
+
+/**
+ * @brief Замеры производительности работы с файлом курса.
+ * Результаты выводятся в лог (qInfo).
+ */
+class CourseBenchmark
+{
+public:
+    /**
+     * @brief Результат замера одного способа загрузки.
+     */
+    struct LoadResult {
+        double firstChapterMs = 0.0; // время до получения первой главы
+        qint64 rssDeltaKb = -1;      // прирост резидентной памяти
+        qint64 peakRssKb = -1;       // пик резидентной памяти процесса
+    };
+
+    /**
+     * @brief Сравнивает загрузку через Course (полная расшифровка)
+     * и через CourseView (отображение файла в память).
+     * Сначала замеряется CourseView, так как пик памяти процесса не убывает.
+     * @param binPath Путь к бинарному файлу курса
+     * @param key Ключ для расшифровки данных
+     * @param iterations Количество повторов для усреднения времени
+     */
+    static void compareLoadPaths(const QString& binPath, const QString& key, int iterations = 20);
+
+    /**
+     * @brief Матрица "размер файла / задержка декодирования" для кодеков сжатия.
+     * Для синтетических курсов разного размера файл записывается каждым
+     * кодеком, после чего замеряются размер, время записи, средняя задержка
+     * декодирования одной главы и время полной загрузки.
+     * @param workDir Каталог для временных файлов (например, сетевой домашний)
+     * @param key Ключ шифрования
+     */
+    static void compareCodecs(const QString& workDir, const QString& key);
+
+    /**
+     * @brief Сравнивает полную перезапись файла курса с журнальным сохранением главы.
+     * @param workDir Каталог для временных файлов
+     * @param key Ключ шифрования
+     * @param chapterCount Количество глав синтетического курса
+     * @param iterations Количество сохранений для усреднения
+     */
+    static void compareSavePaths(const QString& workDir, const QString& key, int chapterCount = 1000,
+                                 int iterations = 20);
+
+    /**
+     * @brief Замеряет масштабирование компиляции JSON -> course.bin по ядрам.
+     * Синтетический курс записывается в JSON и компилируется с разным
+     * числом потоков. Каждый результат сравнивается побайтно с
+     * последовательной записью через CourseManager::saveCourseToBinary.
+     * @param workDir Каталог для временных файлов
+     * @param key Ключ шифрования
+     * @param chapterCount Количество глав синтетического курса
+     */
+    static void compareCompileThreads(const QString& workDir, const QString& key, int chapterCount = 5000);
+
+    /**
+     * @brief Сравнивает XOR и AES-GCM на одном и том же курсе.
+     * Для каждого шифра замеряются размер файла, время записи, время до
+     * первой главы (CourseView), полная параллельная загрузка и глубокая
+     * проверка. Дополнительно выводится скорость самих шифров на одном ядре.
+     * @param workDir Каталог для временных файлов
+     * @param key Ключ шифрования
+     * @param chapterCount Количество глав синтетического курса
+     * @param iterations Количество повторов для усреднения
+     */
+    static void compareCiphers(const QString& workDir, const QString& key, int chapterCount = 2000,
+                               int iterations = 5);
+
+    /**
+     * @brief Замеряет пропускную способность XOR-шифрования в ГБ/с.
+     * Сравниваются прежний побайтовый цикл, CryptoUtils::xorEncryptDecrypt
+     * и XorKeyStream на месте для каждой реализации, поддерживаемой процессором.
+     * @param key Ключ шифрования
+     * @param megabytes Размер буфера
+     * @param iterations Количество повторов для усреднения
+     */
+    static void compareXorKernels(const QString& key, int megabytes = 64, int iterations = 10);
+
+    /**
+     * @brief Создаёт синтетический курс с HTML-содержимым, похожим на реальное.
+     * Содержимое детерминировано и не зависит от запуска.
+     * @param chapterCount Количество глав
+     * @param paragraphsPerChapter Количество абзацев в каждой главе
+     */
+    static Course makeSyntheticCourse(int chapterCount, int paragraphsPerChapter);
+
+    /**
+     * @brief Возвращает текущий объём резидентной памяти процесса в КБ или -1.
+     */
+    static qint64 currentRssKb();
+
+    /**
+     * @brief Возвращает пиковый объём резидентной памяти процесса в КБ или -1.
+     */
+    static qint64 peakRssKb();
+
+private:
+    static LoadResult measureViewLoad(const QString& binPath, const QString& key, int iterations);
+    static LoadResult measureCourseLoad(const QString& binPath, const QString& key, int iterations);
+
+    CourseBenchmark() = delete;
+};
+
+#endif // COURSEBENCHMARK_H
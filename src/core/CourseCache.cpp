@@ -0,0 +1,61 @@
+#include "CourseCache.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include "AppSettings.h"
+#include "CourseManager.h"
+
+CourseCache& CourseCache::getInstance() {
+    static CourseCache instance;
+    return instance;
+}
+
+CourseCache::CourseCache()
+    : m_key(AppSettings::ENCRYPTION_KEY) {
+}
+
+QSharedPointer<const Course> CourseCache::course() {
+    QMutexLocker locker(&m_mutex);
+    if (m_course) {
+        return m_course;
+    }
+
+    // Расшифровка под блокировкой: параллельные запросы дождутся одного снимка
+    QElapsedTimer timer;
+    timer.start();
+    const QString binPath = AppSettings::getCourseReadPath();
+    QSharedPointer<const Course> snapshot(new Course(CourseManager::loadCourseFromBinary(binPath, m_key)));
+    if (snapshot->chapters.isEmpty()) {
+        return snapshot;
+    }
+
+    qInfo() << "Course snapshot decoded from" << binPath << "in" << timer.elapsed() << "ms," << snapshot->chapters.size() << "chapters";
+    m_course = snapshot;
+    return m_course;
+}
+
+QSharedPointer<const CourseView> CourseCache::view() {
+    QMutexLocker locker(&m_mutex);
+    if (m_view) {
+        return m_view;
+    }
+
+    QSharedPointer<CourseView> view(new CourseView());
+    if (!view->open(AppSettings::getCourseReadPath(), m_key)) {
+        return QSharedPointer<const CourseView>();
+    }
+
+    m_view = view;
+    return m_view;
+}
+
+void CourseCache::publish(const QSharedPointer<const Course>& course) {
+    QMutexLocker locker(&m_mutex);
+    m_course = course;
+    m_view.reset();
+}
+
+void CourseCache::invalidate() {
+    QMutexLocker locker(&m_mutex);
+    m_course.reset();
+    m_view.reset();
+}
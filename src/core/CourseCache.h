@@ -0,0 +1,70 @@
+#ifndef COURSECACHE_H
+#define COURSECACHE_H
+
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include "models/Structures.h"
+#include "CourseView.h"
+
+/**
+ * @brief Общий для процесса кэш курса.
+ * Курс расшифровывается с диска один раз, а окна получают неизменяемые
+ * снимки через QSharedPointer. При сохранении из редактора снимок
+ * заменяется атомарно: окна, уже получившие старый снимок, продолжают
+ * работать с ним, новые запросы получают обновлённый.
+ *
+ * Помимо полного снимка (Course) кэш хранит отображённый в память
+ * CourseView для окон, которым достаточно поглавного чтения.
+ *
+ * Файл выбирается через AppSettings::getCourseReadPath() при каждой
+ * загрузке: после первого сохранения редактором кэш переходит со
+ * встроенного курса на копию в AppDataLocation.
+ */
+class CourseCache
+{
+public:
+    /**
+     * @brief Возвращает единственный экземпляр кэша.
+     * Использует путь и ключ из AppSettings.
+     */
+    static CourseCache& getInstance();
+
+    /**
+     * @brief Возвращает снимок курса, расшифровывая файл при первом вызове.
+     * Неудачная загрузка не кэшируется.
+     * @return Снимок курса; пустой курс, если файл не прочитан
+     */
+    QSharedPointer<const Course> course();
+
+    /**
+     * @brief Возвращает общее представление файла курса, открывая его при первом вызове.
+     * @return Представление или nullptr, если файл не открыт
+     */
+    QSharedPointer<const CourseView> view();
+
+    /**
+     * @brief Атомарно заменяет снимок после сохранения курса на диск.
+     * Представление файла сбрасывается и будет открыто заново.
+     * @param course Новый снимок курса
+     */
+    void publish(const QSharedPointer<const Course>& course);
+
+    /**
+     * @brief Сбрасывает снимок и представление, например после перекомпиляции файла.
+     */
+    void invalidate();
+
+    CourseCache(const CourseCache&) = delete;
+    CourseCache& operator=(const CourseCache&) = delete;
+
+private:
+    CourseCache();
+
+    QString m_key;
+    QMutex m_mutex;
+    QSharedPointer<const Course> m_course;
+    QSharedPointer<const CourseView> m_view;
+};
+
+#endif // COURSECACHE_H
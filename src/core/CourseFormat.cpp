@@ -0,0 +1,387 @@
+#include "CourseFormat.h"
+#include <QDataStream>
+#include <QtEndian>
+#include <QFile>
+#include <QDebug>
+#include "Checksum.h"
+#include "CryptoUtils.h"
+#include <lz4.h>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace CourseFormat {
+
+namespace {
+
+const qint64 SLOTS_OFFSET = 16;
+const qint64 SLOT_SIZE = 28;
+// Наибольшая степень сжатия блока LZ4: один байт токена на 255 байт повтора
+const qint64 LZ4_MAX_RATIO = 255;
+
+quint16 slotChecksum(const Header& slot) {
+    QByteArray slotData;
+    QDataStream slotStream(&slotData, QIODevice::WriteOnly);
+    slotStream << slot.generation << slot.indexOffset << slot.chapterCount << slot.indexChecksum;
+    return qChecksum(slotData, Qt::ChecksumIso3309);
+}
+
+// Поля, которые AES-GCM защищает тегом вместе с сегментом: файл и место
+// главы в таблице, а также параметры распаковки
+QByteArray segmentAad(const ChapterEntry& entry) {
+    QByteArray aad;
+    QDataStream aadStream(&aad, QIODevice::WriteOnly);
+    aadStream << entry.fileId << entry.index << entry.rawLength << quint8(entry.codec);
+    return aad;
+}
+
+void writeSlot(QDataStream& stream, const Header& slot) {
+    stream << slot.generation << slot.indexOffset << slot.chapterCount << slot.indexChecksum
+           << slotChecksum(slot) << quint16(0);
+}
+
+} // namespace
+
+quint32 readMagic(const QString& binPath) {
+    QFile file(binPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    stream >> magic;
+    return stream.status() == QDataStream::Ok ? magic : 0;
+}
+
+bool readHeader(QIODevice* device, Header& header) {
+    QDataStream stream(device);
+    quint16 cipher = 0;
+    stream >> header.magic >> header.revision >> cipher >> header.fileId;
+
+    if (stream.status() != QDataStream::Ok || header.magic != MAGIC_NUMBER_V2) {
+        qWarning() << "Invalid course header";
+        return false;
+    }
+
+    if (header.revision != FORMAT_REVISION) {
+        qWarning() << "Unsupported course format revision:" << header.revision;
+        return false;
+    }
+
+    if (cipher > quint16(Cipher::AesGcm)) {
+        qWarning() << "Course file uses unknown cipher" << cipher;
+        return false;
+    }
+    header.cipher = Cipher(cipher);
+
+    const quint64 fileSize = quint64(device->size());
+
+    // Выбираем целый слот с наибольшим поколением
+    bool found = false;
+    for (int slot = 0; slot < INDEX_SLOT_COUNT; ++slot) {
+        Header candidate;
+        quint16 checksum = 0;
+        quint16 slotReserved = 0;
+        stream >> candidate.generation >> candidate.indexOffset >> candidate.chapterCount
+               >> candidate.indexChecksum >> checksum >> slotReserved;
+
+        if (stream.status() != QDataStream::Ok || candidate.generation == 0
+            || checksum != slotChecksum(candidate)
+            || candidate.indexOffset < quint64(HEADER_SIZE) || candidate.indexOffset >= fileSize) {
+            continue;
+        }
+
+        if (!found || candidate.generation > header.generation) {
+            header.generation = candidate.generation;
+            header.indexOffset = candidate.indexOffset;
+            header.chapterCount = candidate.chapterCount;
+            header.indexChecksum = candidate.indexChecksum;
+            header.activeSlot = slot;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        qWarning() << "Course header has no valid index slot";
+        return false;
+    }
+
+    return true;
+}
+
+bool writeHeader(QIODevice* device, const Header& header) {
+    if (!device->seek(0)) {
+        return false;
+    }
+
+    QDataStream stream(device);
+    stream << MAGIC_NUMBER_V2 << FORMAT_REVISION << quint16(header.cipher) << header.fileId;
+    for (int slot = 0; slot < INDEX_SLOT_COUNT; ++slot) {
+        if (slot == header.activeSlot && header.generation != 0) {
+            writeSlot(stream, header);
+        } else {
+            stream << quint64(0) << quint64(0) << quint32(0) << quint32(0) << quint16(0) << quint16(0);
+        }
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+bool writeIndexSlot(QIODevice* device, int slot, const Header& header) {
+    if (slot < 0 || slot >= INDEX_SLOT_COUNT || !device->seek(SLOTS_OFFSET + slot * SLOT_SIZE)) {
+        return false;
+    }
+
+    QDataStream stream(device);
+    writeSlot(stream, header);
+    return stream.status() == QDataStream::Ok;
+}
+
+bool syncToDisk(QFileDevice* device) {
+    if (!device->flush()) {
+        return false;
+    }
+#if defined(Q_OS_WIN)
+    HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(device->handle()));
+    return handle != INVALID_HANDLE_VALUE && FlushFileBuffers(handle) != 0;
+#else
+    return ::fsync(device->handle()) == 0;
+#endif
+}
+
+bool readIndex(QIODevice* device, const Header& header, QList<ChapterEntry>& entries) {
+    if (!device->seek(qint64(header.indexOffset))) {
+        return false;
+    }
+
+    const QByteArray countData = device->read(4);
+    if (countData.size() != 4) {
+        qWarning() << "Corrupted course index";
+        return false;
+    }
+    const quint32 chapterCount = qFromBigEndian<quint32>(countData.constData());
+
+    // Защита от повреждённого счётчика: таблица должна поместиться в файл
+    const quint64 entrySize = quint64(INDEX_ENTRY_SIZE);
+    const quint64 fileSize = quint64(device->size());
+    if (chapterCount != header.chapterCount
+        || quint64(chapterCount) * entrySize > fileSize - header.indexOffset - 4) {
+        qWarning() << "Corrupted course index";
+        return false;
+    }
+
+    // Таблица читается одним блоком, чтобы сверить её CRC32C до разбора
+    const QByteArray indexData = device->read(qint64(chapterCount * entrySize));
+    if (quint64(indexData.size()) != chapterCount * entrySize) {
+        qWarning() << "Corrupted course index";
+        return false;
+    }
+    if (Checksum::crc32c(indexData.constData(), indexData.size(), Checksum::crc32c(countData))
+        != header.indexChecksum) {
+        qWarning() << "Course index checksum mismatch";
+        return false;
+    }
+
+    QDataStream stream(indexData);
+    entries.clear();
+    entries.reserve(chapterCount);
+    for (quint32 i = 0; i < chapterCount; ++i) {
+        ChapterEntry entry;
+        quint8 codec = 0;
+        stream >> entry.offset >> entry.length >> entry.rawLength >> codec >> entry.checksum;
+        if (codec > quint8(Codec::Lz4)) {
+            qWarning() << "Chapter segment" << i << "uses unknown codec" << codec;
+            return false;
+        }
+        entry.codec = Codec(codec);
+        entry.cipher = header.cipher;
+        entry.fileId = header.fileId;
+        entry.index = i;
+
+        if (entry.offset < quint64(HEADER_SIZE) || entry.offset + entry.length > fileSize) {
+            qWarning() << "Chapter segment" << i << "is out of range";
+            return false;
+        }
+        entries.append(entry);
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
+bool writeIndex(QIODevice* device, const QList<ChapterEntry>& entries, Header& header) {
+    QByteArray indexData;
+    QDataStream stream(&indexData, QIODevice::WriteOnly);
+    stream << quint32(entries.size());
+    for (const ChapterEntry& entry : entries) {
+        stream << entry.offset << entry.length << entry.rawLength << quint8(entry.codec) << entry.checksum;
+    }
+
+    header.indexOffset = quint64(device->pos());
+    header.chapterCount = quint32(entries.size());
+    header.indexChecksum = Checksum::crc32c(indexData);
+    return device->write(indexData) == indexData.size();
+}
+
+bool checkSegment(const char* data, qint64 size, const ChapterEntry& entry) {
+    return size == qint64(entry.length) && Checksum::crc32c(data, size) == entry.checksum;
+}
+
+QString codecName(Codec codec) {
+    switch (codec) {
+    case Codec::None:
+        return "none";
+    case Codec::Zlib:
+        return "zlib";
+    case Codec::Lz4:
+        return "lz4";
+    }
+    return "unknown";
+}
+
+bool codecFromName(const QString& name, Codec& codec) {
+    for (Codec candidate : {Codec::None, Codec::Zlib, Codec::Lz4}) {
+        if (name.compare(codecName(candidate), Qt::CaseInsensitive) == 0) {
+            codec = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+QString cipherName(Cipher cipher) {
+    switch (cipher) {
+    case Cipher::Xor:
+        return "xor";
+    case Cipher::AesGcm:
+        return "aes-gcm";
+    }
+    return "unknown";
+}
+
+bool cipherFromName(const QString& name, Cipher& cipher) {
+    for (Cipher candidate : {Cipher::Xor, Cipher::AesGcm}) {
+        if (name.compare(cipherName(candidate), Qt::CaseInsensitive) == 0) {
+            cipher = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+QByteArray compress(const QByteArray& raw, Codec codec) {
+    switch (codec) {
+    case Codec::None:
+        return raw;
+    case Codec::Zlib:
+        return qCompress(raw);
+    case Codec::Lz4: {
+        QByteArray compressed(LZ4_compressBound(int(raw.size())), Qt::Uninitialized);
+        const int size = LZ4_compress_default(raw.constData(), compressed.data(),
+                                              int(raw.size()), int(compressed.size()));
+        if (size <= 0) {
+            return QByteArray();
+        }
+        compressed.resize(size);
+        return compressed;
+    }
+    }
+    return QByteArray();
+}
+
+bool decompress(const QByteArray& data, Codec codec, quint32 rawLength, QByteArray& raw) {
+    switch (codec) {
+    case Codec::None:
+        raw = data;
+        break;
+    case Codec::Zlib:
+        raw = qUncompress(data);
+        break;
+    case Codec::Lz4: {
+        // rawLength берётся из индекса: до выделения буфера он ограничивается
+        // пределом int у LZ4 и наибольшей степенью сжатия блока LZ4 (~255:1)
+        if (data.size() > LZ4_MAX_INPUT_SIZE || rawLength > quint32(LZ4_MAX_INPUT_SIZE)
+            || qint64(rawLength) > LZ4_MAX_RATIO * qint64(data.size())) {
+            qWarning() << "Implausible LZ4 chapter size" << rawLength << "for" << data.size() << "compressed bytes";
+            raw.clear();
+            return false;
+        }
+        raw.resize(qsizetype(rawLength));
+        const int size = LZ4_decompress_safe(data.constData(), raw.data(), int(data.size()), int(rawLength));
+        if (size < 0) {
+            raw.clear();
+            return false;
+        }
+        raw.resize(size);
+        break;
+    }
+    }
+    return quint32(raw.size()) == rawLength;
+}
+
+QByteArray encodeChapter(const Chapter& chapter, const QString& key, Codec codec, Cipher cipher,
+                         quint64 fileId, quint32 chapterIndex, ChapterEntry& entry) {
+    QByteArray chapterData;
+    QDataStream chapterStream(&chapterData, QIODevice::WriteOnly);
+    chapterStream << chapter;
+
+    entry.rawLength = quint32(chapterData.size());
+    entry.codec = Codec::None;
+    entry.cipher = cipher;
+    entry.fileId = fileId;
+    entry.index = chapterIndex;
+
+    // Сжатие до шифрования: зашифрованные данные уже не сжимаются
+    if (codec != Codec::None) {
+        QByteArray compressed = compress(chapterData, codec);
+        if (!compressed.isEmpty() && compressed.size() < chapterData.size()) {
+            chapterData = compressed;
+            entry.codec = codec;
+        }
+    }
+
+    // Сериализованная глава больше не нужна, поэтому XOR применяется на месте
+    QByteArray segment;
+    if (cipher == Cipher::AesGcm) {
+        segment = CryptoUtils::aesGcmEncrypt(chapterData, key, segmentAad(entry));
+    } else {
+        CryptoUtils::xorInPlace(chapterData, key);
+        segment = chapterData;
+    }
+    if (segment.isEmpty()) {
+        qWarning() << "Cannot encrypt chapter" << chapter.id;
+        return QByteArray();
+    }
+    entry.length = quint32(segment.size());
+    entry.checksum = Checksum::crc32c(segment);
+    return segment;
+}
+
+bool decodeSegment(QByteArray segment, const QString& key, const ChapterEntry& entry, QByteArray& raw) {
+    if (entry.cipher == Cipher::AesGcm) {
+        QByteArray data;
+        if (!CryptoUtils::aesGcmDecrypt(segment, key, segmentAad(entry), data)) {
+            qWarning() << "Chapter segment at offset" << entry.offset << "failed authentication";
+            return false;
+        }
+        return decompress(data, entry.codec, entry.rawLength, raw);
+    }
+    CryptoUtils::xorInPlace(segment, key);
+    return decompress(segment, entry.codec, entry.rawLength, raw);
+}
+
+bool decodeChapter(QByteArray segment, const QString& key, const ChapterEntry& entry, Chapter& chapter) {
+    QByteArray chapterData;
+    if (!decodeSegment(std::move(segment), key, entry, chapterData)) {
+        return false;
+    }
+
+    QDataStream chapterStream(&chapterData, QIODevice::ReadOnly);
+    chapterStream >> chapter;
+    return chapterStream.status() == QDataStream::Ok;
+}
+
+} // namespace CourseFormat
@@ -0,0 +1,275 @@
+#ifndef COURSEFORMAT_H
+#define COURSEFORMAT_H
+
+#include <QByteArray>
+#include <QFileDevice>
+#include <QIODevice>
+#include <QList>
+#include <QString>
+#include "models/Structures.h"
+
+/**
+ * @brief Описание бинарного контейнера course.bin.
+ *
+ * Формат v1 (MAGIC_NUMBER_V1): магическое число и один зашифрованный
+ * QByteArray со всем курсом.
+ *
+ * Формат v2 (MAGIC_NUMBER_V2):
+ * @code
+ *   Заголовок (HEADER_SIZE байт):
+ *     quint32 magic        MAGIC_NUMBER_V2
+ *     quint16 revision     FORMAT_REVISION
+ *     quint16 cipher       Cipher сегментов
+ *     quint64 fileId       случайный идентификатор файла AES-GCM (для XOR - 0)
+ *     2 x слот индекса {
+ *       quint64 generation     0 - слот пуст
+ *       quint64 indexOffset    смещение таблицы глав
+ *       quint32 chapterCount   количество глав в таблице
+ *       quint32 indexChecksum  CRC32C таблицы глав целиком
+ *       quint16 checksum       CRC-16 (ISO 3309) предыдущих полей слота
+ *       quint16 reserved       0
+ *     }
+ *   Сегменты глав: каждая глава сериализуется и шифруется независимо
+ *   Таблица глав (по смещению indexOffset):
+ *     quint32 chapterCount
+ *     chapterCount x {
+ *       quint64 offset     смещение сегмента
+ *       quint32 length     длина сегмента в файле
+ *       quint32 rawLength  длина сериализованной главы до сжатия
+ *       quint8  codec      Codec, которым сжат сегмент
+ *       quint32 checksum   CRC32C сегмента в том виде, как он лежит в файле
+ *     }
+ * @endcode
+ * Сегмент главы: QDataStream-сериализация Chapter, сжатая кодеком codec
+ * и затем зашифрованная шифром файла. Кодек выбирается для каждой главы
+ * отдельно: если сжатие не уменьшает размер, глава хранится без сжатия.
+ *
+ * Шифр задаётся для всего файла:
+ * - Cipher::Xor - позиционный XOR с ключом; длина сегмента равна длине
+ *   сжатых данных, любой фрагмент расшифровывается отдельно (CourseView);
+ * - Cipher::AesGcm - AES-256-GCM, сегмент имеет вид nonce || шифртекст || тег
+ *   (см. CryptoUtils::aesGcmEncrypt). Nonce у каждой главы свой. Кроме
+ *   данных главы тег защищает fileId из заголовка, номер главы в таблице,
+ *   rawLength и codec. Поэтому сегмент, перенесённый из другого файла или
+ *   на место другой главы (вместе с записью таблицы), не проходит проверку.
+ *   Таблица глав защищена только CRC32C: замену главы её прежней версией
+ *   из того же файла (до компактификации журнала) тег не обнаруживает.
+ * Все числа записываются в порядке big-endian (QDataStream).
+ *
+ * Контрольные суммы позволяют проверить файл без ключа и без расшифровки:
+ * быстрая проверка читает только заголовок и таблицу глав (сверяя
+ * chapterCount и indexChecksum), глубокая сверяет CRC32C всех сегментов
+ * (см. CourseVerifier).
+ *
+ * Действующим считается слот с корректной контрольной суммой и наибольшим
+ * поколением. Журнальное сохранение (CourseJournal) дописывает новый сегмент
+ * и новую таблицу в конец файла и только затем перезаписывает неактивный
+ * слот, поэтому прерванная запись оставляет файл в прежнем состоянии.
+ *
+ * Файлы другой ревизии не читаются: поле revision оставлено для будущих
+ * изменений формата.
+ */
+namespace CourseFormat {
+
+const quint32 MAGIC_NUMBER_V1 = 0x434F5253; // "CORS"
+const quint32 MAGIC_NUMBER_V2 = 0x43525332; // "CRS2"
+
+const quint16 FORMAT_REVISION = 1;
+const qint64 HEADER_SIZE = 72;
+const int INDEX_SLOT_COUNT = 2;
+const qint64 INDEX_ENTRY_SIZE = 21;
+
+/**
+ * @brief Кодек сжатия сегмента главы.
+ */
+enum class Codec : quint8 {
+    None = 0,
+    Zlib = 1, // qCompress
+    Lz4 = 2   // LZ4 block, быстрая распаковка
+};
+
+/**
+ * @brief Шифр сегментов глав.
+ */
+enum class Cipher : quint8 {
+    Xor = 0,   // CryptoUtils::xorEncryptDecrypt, чтение по полям без расшифровки главы
+    AesGcm = 1 // AES-256-GCM с отдельными nonce и тегом у каждой главы
+};
+
+// Кодек для новых сегментов. Без сжатия CourseView читает поля главы прямо
+// из отображения файла, а сжатую главу пришлось бы распаковывать целиком
+// при каждом переходе. LZ4 (--codec lz4) уменьшает файл в 2-3 раза и
+// выбирается явно, когда важнее размер, чем ленивое чтение
+const Codec DEFAULT_CODEC = Codec::None;
+
+/**
+ * @brief Заголовок контейнера v2 с выбранным действующим слотом.
+ */
+struct Header {
+    quint32 magic = 0;
+    quint16 revision = 0;
+    quint64 indexOffset = 0;
+    quint64 generation = 0;
+    quint32 chapterCount = 0;
+    quint32 indexChecksum = 0;
+    Cipher cipher = Cipher::Xor;
+    quint64 fileId = 0;
+    int activeSlot = 0;
+};
+
+/**
+ * @brief Запись таблицы глав: положение сегмента в файле.
+ */
+struct ChapterEntry {
+    quint64 offset = 0;
+    quint32 length = 0;
+    quint32 rawLength = 0;
+    Codec codec = Codec::None;
+    quint32 checksum = 0;
+    // Не хранятся в таблице: шифр и fileId берутся из заголовка,
+    // index - положение записи в таблице
+    Cipher cipher = Cipher::Xor;
+    quint64 fileId = 0;
+    quint32 index = 0;
+};
+
+/**
+ * @brief Возвращает имя кодека для логов и бенчмарков.
+ */
+QString codecName(Codec codec);
+
+/**
+ * @brief Находит кодек по имени, возвращаемому codecName().
+ * @return true если имя известно
+ */
+bool codecFromName(const QString& name, Codec& codec);
+
+/**
+ * @brief Возвращает имя шифра для логов и командной строки.
+ */
+QString cipherName(Cipher cipher);
+
+/**
+ * @brief Находит шифр по имени, возвращаемому cipherName().
+ * @return true если имя известно
+ */
+bool cipherFromName(const QString& name, Cipher& cipher);
+
+/**
+ * @brief Читает магическое число из начала файла.
+ * @param binPath Путь к бинарному файлу
+ * @return Магическое число или 0, если файл не удалось прочитать
+ */
+quint32 readMagic(const QString& binPath);
+
+/**
+ * @brief Читает и проверяет заголовок v2.
+ * @param device Открытое устройство, позиция в начале файла
+ * @param header Заполняемый заголовок
+ * @return true если заголовок корректен
+ */
+bool readHeader(QIODevice* device, Header& header);
+
+/**
+ * @brief Записывает заголовок текущей ревизии в начало устройства.
+ * Слот header.activeSlot получает поля таблицы из header, второй слот очищается.
+ */
+bool writeHeader(QIODevice* device, const Header& header);
+
+/**
+ * @brief Перезаписывает один слот индекса, не трогая остальной заголовок.
+ * @param device Устройство, открытое на запись
+ * @param slot Номер слота (0 или 1)
+ * @param header Поколение, смещение, число глав и контрольная сумма таблицы
+ */
+bool writeIndexSlot(QIODevice* device, int slot, const Header& header);
+
+/**
+ * @brief Сбрасывает записанные данные файла на диск (fsync).
+ */
+bool syncToDisk(QFileDevice* device);
+
+/**
+ * @brief Читает таблицу глав и проверяет, что сегменты не выходят за пределы файла.
+ * Сверяются число глав и CRC32C таблицы из заголовка; сами сегменты не читаются.
+ * @param device Открытое устройство
+ * @param header Прочитанный заголовок
+ * @param entries Заполняемая таблица
+ * @return true если таблица корректна
+ */
+bool readIndex(QIODevice* device, const Header& header, QList<ChapterEntry>& entries);
+
+/**
+ * @brief Записывает таблицу глав в текущую позицию устройства.
+ * @param device Устройство, открытое на запись
+ * @param entries Таблица глав
+ * @param header Заполняются indexOffset, chapterCount и indexChecksum
+ */
+bool writeIndex(QIODevice* device, const QList<ChapterEntry>& entries, Header& header);
+
+/**
+ * @brief Сверяет CRC32C сегмента с записью таблицы.
+ * @param data Сегмент в том виде, как он лежит в файле
+ * @param size Размер сегмента
+ * @param entry Запись таблицы
+ * @return true если сумма совпала
+ */
+bool checkSegment(const char* data, qint64 size, const ChapterEntry& entry);
+
+/**
+ * @brief Сжимает данные выбранным кодеком.
+ * @return Сжатые данные или пустой массив при ошибке
+ */
+QByteArray compress(const QByteArray& raw, Codec codec);
+
+/**
+ * @brief Распаковывает данные сегмента.
+ * @param data Сжатые данные
+ * @param codec Кодек сегмента
+ * @param rawLength Ожидаемая длина после распаковки
+ * @param raw Результат распаковки
+ * @return true если длина результата совпала с rawLength
+ */
+bool decompress(const QByteArray& data, Codec codec, quint32 rawLength, QByteArray& raw);
+
+/**
+ * @brief Сериализует, сжимает и шифрует одну главу в независимый сегмент.
+ * @param chapter Глава
+ * @param key Ключ шифрования
+ * @param codec Желаемый кодек; если сжатие невыгодно, используется Codec::None
+ * @param cipher Шифр файла
+ * @param fileId Идентификатор файла из заголовка
+ * @param chapterIndex Номер главы в таблице глав
+ * @param entry Заполняются length, rawLength, фактический codec, cipher, fileId,
+ * index и checksum
+ * @return Сегмент для записи в файл или пустой массив при ошибке шифрования
+ */
+QByteArray encodeChapter(const Chapter& chapter, const QString& key, Codec codec, Cipher cipher,
+                         quint64 fileId, quint32 chapterIndex, ChapterEntry& entry);
+
+/**
+ * @brief Расшифровывает сегмент и распаковывает его до сериализованной главы.
+ * Для Cipher::AesGcm сегмент с неверным тегом отклоняется.
+ * @param segment Зашифрованный сегмент. XOR снимается на месте, поэтому
+ * переданный через std::move буфер не копируется; сегмент из отображения
+ * файла (QByteArray::fromRawData) копируется один раз
+ * @param key Ключ шифрования
+ * @param entry Запись таблицы для сегмента
+ * @param raw Сериализованная глава
+ * @return true если сегмент успешно распакован
+ */
+bool decodeSegment(QByteArray segment, const QString& key, const ChapterEntry& entry, QByteArray& raw);
+
+/**
+ * @brief Расшифровывает, распаковывает и десериализует сегмент главы.
+ * @param segment Зашифрованный сегмент (см. decodeSegment)
+ * @param key Ключ шифрования
+ * @param entry Запись таблицы для сегмента
+ * @param chapter Заполняемая глава
+ * @return true если сегмент успешно декодирован
+ */
+bool decodeChapter(QByteArray segment, const QString& key, const ChapterEntry& entry, Chapter& chapter);
+
+} // namespace CourseFormat
+
+#endif // COURSEFORMAT_H
@@ -0,0 +1,178 @@
+#include "CourseJournal.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QtConcurrent>
+#include "CourseFormat.h"
+#include "CourseManager.h"
+#include "CourseWriter.h"
+
+CourseJournal::CourseJournal(const QString& binPath, const QString& key)
+    : m_binPath(binPath), m_key(key) {
+}
+
+CourseJournal::~CourseJournal() {
+    waitForCompaction();
+}
+
+void CourseJournal::waitForCompaction() {
+    m_compaction.waitForFinished();
+}
+
+QString CourseJournal::errorString() const {
+    return m_errorString;
+}
+
+bool CourseJournal::saveChapter(const Course& course, int chapterIndex) {
+    if (chapterIndex < 0 || chapterIndex >= course.chapters.size()) {
+        m_errorString = QString("Invalid chapter index: %1").arg(chapterIndex);
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile file(m_binPath);
+    CourseFormat::Header header;
+    QList<CourseFormat::ChapterEntry> entries;
+
+    const bool canAppend = file.open(QIODevice::ReadWrite)
+        && CourseFormat::readHeader(&file, header)
+        && CourseFormat::readIndex(&file, header, entries)
+        && entries.size() == course.chapters.size();
+
+    if (!canAppend) {
+        file.close();
+        qInfo() << "Course file cannot be appended, rewriting it completely:" << m_binPath;
+        // Шифр файла сохраняется; для нечитаемого заголовка остаётся XOR по умолчанию
+        if (!CourseManager::saveCourseToBinary(course, m_binPath, m_key, CourseFormat::DEFAULT_CODEC,
+                                               header.cipher)) {
+            m_errorString = QString("Failed to rewrite course file: %1").arg(m_binPath);
+            return false;
+        }
+        return true;
+    }
+
+    // 1. Новый сегмент главы и новая таблица дописываются в конец файла
+    CourseFormat::ChapterEntry entry;
+    const QByteArray segment = CourseFormat::encodeChapter(
+        course.chapters[chapterIndex], m_key, CourseFormat::DEFAULT_CODEC, header.cipher, header.fileId,
+        quint32(chapterIndex), entry);
+    if (segment.isEmpty()) {
+        m_errorString = QString("Failed to encrypt chapter %1").arg(chapterIndex);
+        return false;
+    }
+    entry.offset = quint64(file.size());
+    entries[chapterIndex] = entry;
+
+    if (!file.seek(qint64(entry.offset)) || file.write(segment) != segment.size()) {
+        m_errorString = QString("Failed to append chapter segment: %1").arg(file.errorString());
+        qWarning() << m_errorString;
+        return false;
+    }
+
+    CourseFormat::Header next = header;
+    if (!CourseFormat::writeIndex(&file, entries, next) || !CourseFormat::syncToDisk(&file)) {
+        m_errorString = QString("Failed to append chapter index: %1").arg(file.errorString());
+        qWarning() << m_errorString;
+        return false;
+    }
+
+    // 2. Только после того как данные на диске, переключаем неактивный слот.
+    // Сбой до этого момента оставляет действующей прежнюю таблицу.
+    const int nextSlot = (header.activeSlot + 1) % CourseFormat::INDEX_SLOT_COUNT;
+    next.generation = header.generation + 1;
+    if (!CourseFormat::writeIndexSlot(&file, nextSlot, next)
+        || !CourseFormat::syncToDisk(&file)) {
+        m_errorString = QString("Failed to switch course index: %1").arg(file.errorString());
+        qWarning() << m_errorString;
+        return false;
+    }
+
+    qint64 liveBytes = CourseFormat::HEADER_SIZE + 4 + CourseFormat::INDEX_ENTRY_SIZE * entries.size();
+    for (const CourseFormat::ChapterEntry& liveEntry : entries) {
+        liveBytes += liveEntry.length;
+    }
+    const qint64 deadBytes = file.size() - liveBytes;
+    file.close();
+
+    qInfo() << "Chapter" << chapterIndex << "saved to journal in" << timer.elapsed() << "ms,"
+            << deadBytes << "dead bytes in file";
+
+    if (deadBytes > COMPACTION_MIN_DEAD_BYTES && deadBytes > liveBytes) {
+        scheduleCompaction();
+    }
+    return true;
+}
+
+void CourseJournal::scheduleCompaction() {
+    if (m_compaction.isRunning()) {
+        return;
+    }
+    m_compaction = QtConcurrent::run([this]() { return compact(); });
+}
+
+bool CourseJournal::compact() {
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile source(m_binPath);
+    CourseFormat::Header header;
+    QList<CourseFormat::ChapterEntry> entries;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!source.open(QIODevice::ReadOnly)
+            || !CourseFormat::readHeader(&source, header)
+            || !CourseFormat::readIndex(&source, header, entries)) {
+            qWarning() << "Compaction skipped: cannot read" << m_binPath;
+            return false;
+        }
+    }
+
+    // Копирование идёт без блокировки: файл только дописывается, поэтому
+    // сегменты из прочитанной таблицы не меняются во время работы
+    CourseWriter writer;
+    writer.setCipher(header.cipher);
+    writer.setFileId(header.fileId);
+    if (!writer.open(m_binPath, m_key)) {
+        return false;
+    }
+
+    for (const CourseFormat::ChapterEntry& entry : entries) {
+        source.seek(qint64(entry.offset));
+        const QByteArray segment = source.read(entry.length);
+
+        // Повреждённый сегмент не переносится молча в новый файл
+        if (!CourseFormat::checkSegment(segment.constData(), segment.size(), entry)) {
+            qWarning() << "Compaction aborted: chapter segment at offset" << entry.offset << "is corrupted";
+            writer.cancel();
+            return false;
+        }
+        if (!writer.addSegment(segment, entry)) {
+            writer.cancel();
+            return false;
+        }
+    }
+    source.close();
+
+    // Заменяем файл, только если за время копирования не было новых сохранений
+    QMutexLocker locker(&m_mutex);
+    QFile current(m_binPath);
+    CourseFormat::Header currentHeader;
+    if (!current.open(QIODevice::ReadOnly) || !CourseFormat::readHeader(&current, currentHeader)
+        || currentHeader.generation != header.generation || currentHeader.indexOffset != header.indexOffset) {
+        qInfo() << "Compaction discarded: course file changed while compacting";
+        writer.cancel();
+        return false;
+    }
+    current.close();
+
+    if (!writer.commit()) {
+        return false;
+    }
+
+    qInfo() << "Course file compacted in" << timer.elapsed() << "ms";
+    return true;
+}
@@ -0,0 +1,76 @@
+#ifndef COURSEJOURNAL_H
+#define COURSEJOURNAL_H
+
+#include <QFuture>
+#include <QMutex>
+#include <QString>
+#include "models/Structures.h"
+
+/**
+ * @brief Журнальное сохранение отдельных глав в course.bin.
+ *
+ * Изменённая глава дописывается в конец файла вместе с новой таблицей глав,
+ * после чего неактивный слот индекса в заголовке атомарно переключается на
+ * неё (см. CourseFormat). Время сохранения зависит от размера главы, а не
+ * всего курса.
+ *
+ * Старые версии глав остаются в файле как мёртвые байты. Когда их становится
+ * больше, чем живых, запускается фоновая компактификация: живые сегменты
+ * копируются в новый файл, который атомарно заменяет старый.
+ */
+class CourseJournal
+{
+public:
+    /**
+     * @brief Создаёт журнал для файла курса.
+     * @param binPath Путь к бинарному файлу
+     * @param key Ключ для шифрования данных
+     */
+    CourseJournal(const QString& binPath, const QString& key);
+
+    /**
+     * @brief Дожидается завершения фоновой компактификации.
+     */
+    ~CourseJournal();
+
+    /**
+     * @brief Сохраняет одну главу курса.
+     * Если файл нельзя дописать (старый формат или другое число глав),
+     * курс перезаписывается целиком.
+     * @param course Курс с уже изменённой главой
+     * @param chapterIndex Индекс изменённой главы
+     * @return true если изменения сохранены на диск
+     */
+    bool saveChapter(const Course& course, int chapterIndex);
+
+    /**
+     * @brief Блокирует до завершения фоновой компактификации.
+     */
+    void waitForCompaction();
+
+    QString errorString() const;
+
+    CourseJournal(const CourseJournal&) = delete;
+    CourseJournal& operator=(const CourseJournal&) = delete;
+
+private:
+    /**
+     * @brief Переписывает файл, оставляя только живые сегменты.
+     * Выполняется в фоновом потоке.
+     * @return true если файл заменён
+     */
+    bool compact();
+
+    void scheduleCompaction();
+
+    // Компактификация не запускается, пока мёртвых байт меньше этого порога
+    static const qint64 COMPACTION_MIN_DEAD_BYTES = 1024 * 1024;
+
+    QString m_binPath;
+    QString m_key;
+    QMutex m_mutex;
+    QFuture<bool> m_compaction;
+    QString m_errorString;
+};
+
+#endif // COURSEJOURNAL_H
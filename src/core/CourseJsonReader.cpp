@@ -0,0 +1,232 @@
+#include "CourseJsonReader.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QDebug>
+
+namespace {
+
+const qint64 READ_CHUNK_SIZE = 256 * 1024;
+
+bool isJsonWhitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+} // namespace
+
+CourseJsonReader::CourseJsonReader(QIODevice* device)
+    : m_device(device), m_pos(0), m_bytesRead(0), m_state(State::Start), m_expectSeparator(false)
+    , m_afterSeparator(false) {
+}
+
+bool CourseJsonReader::hasError() const {
+    return m_state == State::Error;
+}
+
+QString CourseJsonReader::errorString() const {
+    return m_errorString;
+}
+
+qint64 CourseJsonReader::bytesRead() const {
+    return m_bytesRead;
+}
+
+bool CourseJsonReader::fail(const QString& message) {
+    m_state = State::Error;
+    m_errorString = message;
+    qWarning() << "JSON parse error:" << message << "at byte" << (m_bytesRead - m_buffer.size() + m_pos);
+    return false;
+}
+
+bool CourseJsonReader::ensureData() {
+    if (m_pos < m_buffer.size()) {
+        return true;
+    }
+
+    m_buffer = m_device->read(READ_CHUNK_SIZE);
+    m_pos = 0;
+    m_bytesRead += m_buffer.size();
+    return !m_buffer.isEmpty();
+}
+
+bool CourseJsonReader::nextSignificant(char& c) {
+    while (ensureData()) {
+        c = m_buffer.at(m_pos++);
+        if (!isJsonWhitespace(c)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CourseJsonReader::captureValue(char first, QByteArray& value) {
+    value.clear();
+    value.append(first);
+
+    // Скаляр (число, true/false/null) заканчивается на разделителе
+    if (first != '{' && first != '[' && first != '"') {
+        while (ensureData()) {
+            const char c = m_buffer.at(m_pos);
+            if (c == ',' || c == ']' || c == '}' || isJsonWhitespace(c)) {
+                return true;
+            }
+            value.append(c);
+            ++m_pos;
+        }
+        return true;
+    }
+
+    int depth = (first == '"') ? 0 : 1;
+    bool inString = (first == '"');
+    bool escape = false;
+
+    // Блок буфера копируется в value целиком, а не по одному символу
+    while (ensureData()) {
+        const char* data = m_buffer.constData();
+        const int size = m_buffer.size();
+        const int start = m_pos;
+
+        for (; m_pos < size; ++m_pos) {
+            const char c = data[m_pos];
+            if (inString) {
+                if (escape) {
+                    escape = false;
+                } else if (c == '\\') {
+                    escape = true;
+                } else if (c == '"') {
+                    inString = false;
+                    if (depth == 0) {
+                        ++m_pos;
+                        value.append(data + start, m_pos - start);
+                        return true;
+                    }
+                }
+                continue;
+            }
+
+            if (c == '"') {
+                inString = true;
+            } else if (c == '{' || c == '[') {
+                ++depth;
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) {
+                    ++m_pos;
+                    value.append(data + start, m_pos - start);
+                    return true;
+                }
+            }
+        }
+
+        value.append(data + start, size - start);
+    }
+
+    return false;
+}
+
+bool CourseJsonReader::readNextElement(QByteArray& element) {
+    while (m_state == State::Start || m_state == State::InArray) {
+        char c = 0;
+
+        if (m_state == State::Start) {
+            if (!nextSignificant(c)) {
+                return fail("JSON document is empty");
+            }
+            // Пропуск UTF-8 BOM
+            if (m_pos == 1 && m_buffer.startsWith("\xEF\xBB\xBF")) {
+                m_pos = 3;
+                if (!nextSignificant(c)) {
+                    return fail("JSON document is empty");
+                }
+            }
+            if (c != '[') {
+                return fail("JSON document is not an array");
+            }
+            m_state = State::InArray;
+            continue;
+        }
+
+        if (!nextSignificant(c)) {
+            return fail("Unexpected end of JSON document");
+        }
+
+        if (c == ']') {
+            if (m_afterSeparator) {
+                return fail("Trailing ',' before end of array");
+            }
+            // После массива допускаются только пробельные символы
+            if (nextSignificant(c)) {
+                return fail("Unexpected data after JSON array");
+            }
+            m_state = State::Done;
+            return false;
+        }
+
+        if (m_expectSeparator) {
+            if (c != ',') {
+                return fail("Expected ',' between array elements");
+            }
+            m_expectSeparator = false;
+            m_afterSeparator = true;
+            continue;
+        }
+
+        if (c != '{') {
+            return fail("Array element is not a chapter object");
+        }
+
+        QByteArray value;
+        if (!captureValue(c, value)) {
+            return fail("Unexpected end of JSON document");
+        }
+        m_expectSeparator = true;
+        m_afterSeparator = false;
+
+        element = value;
+        return true;
+    }
+
+    return false;
+}
+
+bool CourseJsonReader::parseChapter(const QByteArray& element, Chapter& chapter, QString& errorString) {
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(element, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        errorString = parseError.errorString();
+        return false;
+    }
+
+    chapter = chapterFromJson(doc.object());
+    return true;
+}
+
+Chapter CourseJsonReader::chapterFromJson(const QJsonObject& chapterObj) {
+    Chapter chapter;
+    chapter.id = chapterObj["id"].toInt();
+    chapter.title = chapterObj["title"].toString();
+    chapter.content = chapterObj["content"].toString();
+
+    // Парсинг вопросов для текущей главы
+    const QJsonArray questionsArray = chapterObj["questions"].toArray();
+    for (const QJsonValue& questionValue : questionsArray) {
+        if (!questionValue.isObject()) {
+            continue;
+        }
+
+        const QJsonObject questionObj = questionValue.toObject();
+
+        Question question;
+        question.q_text = questionObj["q_text"].toString();
+        question.correct_index = questionObj["correct_index"].toInt();
+
+        // Парсинг вариантов ответов
+        const QJsonArray optionsArray = questionObj["options"].toArray();
+        for (const QJsonValue& optionValue : optionsArray) {
+            question.options.append(optionValue.toString());
+        }
+
+        chapter.questions.append(question);
+    }
+
+    return chapter;
+}
@@ -0,0 +1,76 @@
+#ifndef COURSEJSONREADER_H
+#define COURSEJSONREADER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QJsonObject>
+#include <QString>
+#include "models/Structures.h"
+
+/**
+ * @brief Потоковое чтение JSON-источника курса.
+ * Источник - массив объектов глав. Устройство читается блоками, из потока
+ * выделяется очередной элемент массива, и разбирается только он. Поэтому
+ * память ограничена размером самой большой главы, а не всего файла.
+ */
+class CourseJsonReader
+{
+public:
+    /**
+     * @brief Создаёт читатель поверх открытого устройства.
+     * @param device Устройство, открытое на чтение
+     */
+    explicit CourseJsonReader(QIODevice* device);
+
+    /**
+     * @brief Выделяет следующий объект массива, не разбирая его.
+     * Разбор можно выполнить позже в другом потоке (см. parseChapter).
+     * Элемент, не являющийся объектом, запятая перед ']' и данные после
+     * массива считаются ошибкой (hasError()).
+     * @param element Байты JSON-объекта главы
+     * @return true если объект выделен, false в конце массива или при ошибке
+     */
+    bool readNextElement(QByteArray& element);
+
+    bool hasError() const;
+    QString errorString() const;
+
+    /**
+     * @brief Количество байт, прочитанных из устройства.
+     */
+    qint64 bytesRead() const;
+
+    /**
+     * @brief Заполняет главу из JSON-объекта.
+     */
+    static Chapter chapterFromJson(const QJsonObject& chapterObj);
+
+    /**
+     * @brief Разбирает JSON-объект главы, выделенный readNextElement().
+     * Не зависит от состояния читателя и безопасен для вызова из разных потоков.
+     * @param element Байты JSON-объекта
+     * @param chapter Заполняемая глава
+     * @param errorString Описание ошибки разбора
+     * @return true если объект разобран
+     */
+    static bool parseChapter(const QByteArray& element, Chapter& chapter, QString& errorString);
+
+private:
+    enum class State { Start, InArray, Done, Error };
+
+    bool ensureData();
+    bool nextSignificant(char& c);
+    bool captureValue(char first, QByteArray& value);
+    bool fail(const QString& message);
+
+    QIODevice* m_device;
+    QByteArray m_buffer;
+    int m_pos;
+    qint64 m_bytesRead;
+    State m_state;
+    bool m_expectSeparator;
+    bool m_afterSeparator;   // прочитана ',' и ещё нет следующего элемента
+    QString m_errorString;
+};
+
+#endif // COURSEJSONREADER_H
@@ -1,14 +1,92 @@
 #include "CourseManager.h"
+#include <QAtomicInt>
 #include <QFile>
-#include <QJsonDocument>
-#include <QJsonArray>
-#include <QJsonObject>
+#include <QSaveFile>
 #include <QDataStream>
 #include <QDebug>
 #include <QDir>
 #include <QFileInfo>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <functional>
+#include "CourseFormat.h"
+#include "CourseJsonReader.h"
+#include "CourseWriter.h"
 #include "CryptoUtils.h"
 
+namespace {
+
+// Количество глав, которые выделяются из JSON и обрабатываются за один проход
+// пула потоков. В памяти одновременно находятся не более двух пакетов.
+const int COMPILE_BATCH_SIZE = 256;
+
+// Результат обработки одной главы в рабочем потоке
+struct CompiledChapter {
+    Chapter chapter;
+    QByteArray segment;
+    CourseFormat::ChapterEntry entry;
+    QString errorString;
+};
+
+// Выделяет из JSON очередной пакет объектов глав (в вызывающем потоке)
+QList<QByteArray> readBatch(CourseJsonReader& reader) {
+    QList<QByteArray> batch;
+    batch.reserve(COMPILE_BATCH_SIZE);
+
+    QByteArray element;
+    while (batch.size() < COMPILE_BATCH_SIZE && reader.readNextElement(element)) {
+        batch.append(element);
+    }
+    return batch;
+}
+
+// Разбирает и проверяет главу; вызывается из рабочих потоков
+bool parseAndValidate(const QByteArray& element, CompiledChapter& result) {
+    if (!CourseJsonReader::parseChapter(element, result.chapter, result.errorString)) {
+        return false;
+    }
+
+    for (int q = 0; q < result.chapter.questions.size(); ++q) {
+        const Question& question = result.chapter.questions[q];
+        if (question.correct_index < 0 || question.correct_index >= question.options.size()) {
+            qWarning() << "Chapter" << result.chapter.id << "question" << q
+                       << "has correct_index" << question.correct_index << "out of range";
+        }
+    }
+    return true;
+}
+
+// Обрабатывает пакет в пуле потоков. Порядок результатов совпадает
+// с порядком глав в JSON независимо от порядка завершения задач.
+// firstIndex - номер первой главы пакета в файле, к нему привязан тег AES-GCM.
+QFuture<CompiledChapter> startBatch(const QList<QByteArray>& batch, int firstIndex, quint64 fileId,
+                                    const QString& key, CourseFormat::Codec codec, CourseFormat::Cipher cipher,
+                                    bool encode) {
+    QList<int> positions;
+    positions.reserve(batch.size());
+    for (int i = 0; i < batch.size(); ++i) {
+        positions.append(i);
+    }
+
+    const std::function<CompiledChapter(const int&)> process =
+        [batch, firstIndex, fileId, key, codec, cipher, encode](const int& position) {
+            CompiledChapter result;
+            if (parseAndValidate(batch[position], result) && encode) {
+                result.segment = CourseFormat::encodeChapter(result.chapter, key, codec, cipher, fileId,
+                                                             quint32(firstIndex + position), result.entry);
+                if (result.segment.isEmpty()) {
+                    result.errorString = QString("cannot encrypt chapter %1").arg(result.chapter.id);
+                }
+                result.chapter = Chapter(); // глава больше не нужна, в файл идёт сегмент
+            }
+            return result;
+        };
+    return QtConcurrent::mapped(positions, process);
+}
+
+} // namespace
+
 Course CourseManager::loadCourseFromJSON(const QString& jsonPath) {
     Course course;
 
@@ -18,88 +96,160 @@ Course CourseManager::loadCourseFromJSON(const QString& jsonPath) {
         return course;
     }
 
-    QByteArray jsonData = file.readAll();
-    file.close();
-
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(jsonData, &parseError);
+    // Следующий пакет выделяется из JSON, пока предыдущий разбирается в пуле
+    CourseJsonReader reader(&file);
+    QFuture<CompiledChapter> pending;
+    bool hasPending = false;
+
+    while (true) {
+        const QList<QByteArray> batch = readBatch(reader);
+
+        if (hasPending) {
+            const QList<CompiledChapter> results = pending.results();
+            for (const CompiledChapter& result : results) {
+                if (!result.errorString.isEmpty()) {
+                    qWarning() << "JSON parse error:" << result.errorString << "in" << jsonPath;
+                    return Course();
+                }
+                course.chapters.append(result.chapter);
+            }
+        }
 
-    if (parseError.error != QJsonParseError::NoError) {
-        qWarning() << "JSON parse error:" << parseError.errorString();
-        return course;
+        if (batch.isEmpty()) {
+            break;
+        }
+        pending = startBatch(batch, 0, 0, QString(), CourseFormat::Codec::None, CourseFormat::Cipher::Xor, false);
+        hasPending = true;
     }
 
-    if (!doc.isArray()) {
-        qWarning() << "JSON document is not an array";
-        return course;
+    if (reader.hasError()) {
+        return Course();
     }
 
-    QJsonArray chaptersArray = doc.array();
+    return course;
+}
 
-    // Обработка каждой главы курса
-    for (const QJsonValue& chapterValue : chaptersArray) {
-        if (!chapterValue.isObject()) {
-            continue;
-        }
+bool CourseManager::compileCourseFromJSON(const QString& jsonPath, const QString& binPath, const QString& key,
+                                          CourseFormat::Codec codec, CourseFormat::Cipher cipher) {
+    QFile jsonFile(jsonPath);
+    if (!jsonFile.open(QIODevice::ReadOnly)) {
+        qWarning() << "Cannot open JSON file:" << jsonPath;
+        return false;
+    }
 
-        QJsonObject chapterObj = chapterValue.toObject();
+    CourseWriter writer;
+    writer.setCodec(codec);
+    writer.setCipher(cipher);
+    if (!writer.open(binPath, key)) {
+        return false;
+    }
 
-        Chapter chapter;
-        chapter.id = chapterObj["id"].toInt();
-        chapter.title = chapterObj["title"].toString();
-        chapter.content = chapterObj["content"].toString();
-
-        // Парсинг вопросов для текущей главы
-        QJsonArray questionsArray = chapterObj["questions"].toArray();
-        for (const QJsonValue& questionValue : questionsArray) {
-            if (!questionValue.isObject()) {
-                continue;
+    QElapsedTimer timer;
+    timer.start();
+
+    // Конвейер: пока пул потоков разбирает, сжимает и шифрует пакет N,
+    // вызывающий поток выделяет из JSON пакет N+1, а затем записывает
+    // сегменты пакета N в исходном порядке. Номер главы в файле известен до
+    // кодирования, поэтому результат совпадает с последовательной записью.
+    CourseJsonReader reader(&jsonFile);
+    QFuture<CompiledChapter> pending;
+    bool hasPending = false;
+    int nextIndex = 0;
+
+    while (true) {
+        const QList<QByteArray> batch = readBatch(reader);
+
+        if (hasPending) {
+            const QList<CompiledChapter> results = pending.results();
+            for (const CompiledChapter& result : results) {
+                if (!result.errorString.isEmpty()) {
+                    qWarning() << "Cannot compile chapter:" << result.errorString << "in" << jsonPath;
+                    writer.cancel();
+                    return false;
+                }
+                if (!writer.addSegment(result.segment, result.entry)) {
+                    writer.cancel();
+                    return false;
+                }
             }
+        }
 
-            QJsonObject questionObj = questionValue.toObject();
+        if (batch.isEmpty()) {
+            break;
+        }
+        pending = startBatch(batch, nextIndex, writer.fileId(), key, writer.codec(), writer.cipher(), true);
+        nextIndex += batch.size();
+        hasPending = true;
+    }
 
-            Question question;
-            question.q_text = questionObj["q_text"].toString();
-            question.correct_index = questionObj["correct_index"].toInt();
+    if (reader.hasError() || writer.chapterCount() == 0) {
+        qWarning() << "No chapters compiled from" << jsonPath;
+        writer.cancel();
+        return false;
+    }
 
-            // Парсинг вариантов ответов
-            QJsonArray optionsArray = questionObj["options"].toArray();
-            for (const QJsonValue& optionValue : optionsArray) {
-                question.options.append(optionValue.toString());
-            }
+    const int chapterCount = writer.chapterCount();
+    if (!writer.commit()) {
+        return false;
+    }
 
-            chapter.questions.append(question);
-        }
+    const qint64 elapsedMs = qMax<qint64>(timer.elapsed(), 1);
+    const double megabytes = double(reader.bytesRead()) / (1024.0 * 1024.0);
+    qInfo().noquote() << QString("Compiled %1 chapters from %2 (%3 MB) in %4 ms, %5 MB/s, %6 threads")
+                             .arg(chapterCount)
+                             .arg(jsonPath)
+                             .arg(megabytes, 0, 'f', 2)
+                             .arg(elapsedMs)
+                             .arg(megabytes * 1000.0 / elapsedMs, 0, 'f', 1)
+                             .arg(QThreadPool::globalInstance()->maxThreadCount());
+    return true;
+}
 
-        course.chapters.append(chapter);
+bool CourseManager::saveCourseToBinary(const Course& course, const QString& binPath, const QString& key,
+                                       CourseFormat::Codec codec, CourseFormat::Cipher cipher) {
+    CourseWriter writer;
+    writer.setCodec(codec);
+    writer.setCipher(cipher);
+    if (!writer.open(binPath, key)) {
+        return false;
     }
 
-    return course;
-}
+    for (const Chapter& chapter : course.chapters) {
+        if (!writer.addChapter(chapter)) {
+            writer.cancel();
+            return false;
+        }
+    }
 
-bool CourseManager::saveCourseToBinary(const Course& course, const QString& binPath, const QString& key) {
-    QFile file(binPath);
-    if (!file.open(QIODevice::WriteOnly)) {
-        qWarning() << "Cannot open binary file for writing:" << binPath << "Error:" << file.errorString();
+    if (!writer.commit()) {
         return false;
     }
 
+    qInfo() << "Курс успешно сохранен в:" << binPath;
+    return true;
+}
+
+bool CourseManager::saveCourseToLegacyBinary(const Course& course, const QString& binPath, const QString& key) {
     QByteArray courseData;
     QDataStream courseStream(&courseData, QIODevice::WriteOnly);
     courseStream << course;
 
-    QByteArray encryptedData = CryptoUtils::xorEncryptDecrypt(courseData, key);
+    QSaveFile file(binPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot open binary file for writing:" << binPath;
+        return false;
+    }
 
+    CryptoUtils::xorInPlace(courseData, key);
     QDataStream fileStream(&file);
-    fileStream << MAGIC_NUMBER;
-    fileStream << encryptedData;
-
-    file.close();
-    qInfo() << "Курс успешно сохранен в:" << binPath;
+    fileStream << CourseFormat::MAGIC_NUMBER_V1 << courseData;
+    if (fileStream.status() != QDataStream::Ok || !file.commit()) {
+        qWarning() << "Cannot write binary file:" << binPath;
+        return false;
+    }
     return true;
 }
 
-
 Course CourseManager::loadCourseFromBinary(const QString& binPath, const QString& key) {
     Course course;
 
@@ -115,7 +265,12 @@ Course CourseManager::loadCourseFromBinary(const QString& binPath, const QString
     quint32 magicNumber;
     fileStream >> magicNumber;
 
-    if (magicNumber != MAGIC_NUMBER) {
+    if (magicNumber == CourseFormat::MAGIC_NUMBER_V2) {
+        file.seek(0);
+        return loadCourseFromContainer(file, key);
+    }
+
+    if (magicNumber != CourseFormat::MAGIC_NUMBER_V1) {
         qWarning() << "Invalid file format - magic number mismatch";
         file.close();
         return course;
@@ -126,12 +281,61 @@ Course CourseManager::loadCourseFromBinary(const QString& binPath, const QString
     fileStream >> encryptedData;
     file.close();
 
-    // Расшифровка данных
-    QByteArray decryptedData = CryptoUtils::xorEncryptDecrypt(encryptedData, key);
+    // Расшифровка данных на месте
+    CryptoUtils::xorInPlace(encryptedData, key);
 
     // Десериализация курса из расшифрованных данных
-    QDataStream courseStream(&decryptedData, QIODevice::ReadOnly);
+    QDataStream courseStream(&encryptedData, QIODevice::ReadOnly);
     courseStream >> course;
 
     return course;
 }
+
+Course CourseManager::loadCourseFromContainer(QFile& file, const QString& key) {
+    Course course;
+
+    CourseFormat::Header header;
+    QList<CourseFormat::ChapterEntry> entries;
+    if (!CourseFormat::readHeader(&file, header) || !CourseFormat::readIndex(&file, header, entries)) {
+        return course;
+    }
+
+    // Главы независимы друг от друга, поэтому расшифровываются (для AES-GCM -
+    // и проверяются) параллельно. Сегменты берутся из отображения файла;
+    // если отобразить файл нельзя, они читаются заранее в вызывающем потоке.
+    uchar* mapped = file.map(0, file.size());
+    QList<QByteArray> segments;
+    segments.reserve(entries.size());
+    for (const CourseFormat::ChapterEntry& entry : entries) {
+        if (mapped) {
+            segments.append(QByteArray::fromRawData(reinterpret_cast<const char*>(mapped) + entry.offset,
+                                                    qsizetype(entry.length)));
+        } else {
+            file.seek(qint64(entry.offset));
+            segments.append(file.read(entry.length));
+        }
+    }
+
+    QList<int> indexes;
+    indexes.reserve(entries.size());
+    for (int i = 0; i < entries.size(); ++i) {
+        indexes.append(i);
+    }
+
+    QAtomicInt failed(0);
+    const std::function<Chapter(const int&)> decode = [&](const int& index) {
+        Chapter chapter;
+        if (!CourseFormat::decodeChapter(segments[index], key, entries[index], chapter)) {
+            qWarning() << "Corrupted chapter segment at offset" << entries[index].offset;
+            failed.storeRelaxed(1);
+        }
+        return chapter;
+    };
+    course.chapters = QtConcurrent::blockingMapped<QList<Chapter>>(indexes, decode);
+
+    segments.clear();
+    if (mapped) {
+        file.unmap(mapped);
+    }
+    return failed.loadRelaxed() ? Course() : course;
+}
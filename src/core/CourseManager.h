@@ -2,7 +2,9 @@
 #define COURSEMANAGER_H
 
 #include <QString>
+#include <QFile>
 #include "models/Structures.h"
+#include "CourseFormat.h"
 
 /**
  * @brief Класс для управления курсами.
@@ -14,22 +16,61 @@ class CourseManager
 public:
     /**
      * @brief Загружает курс из JSON файла.
+     * Главы разбираются параллельно в глобальном пуле потоков.
      * @param jsonPath Путь к JSON файлу с данными курса
      * @return Объект Course с загруженными данными
      */
     static Course loadCourseFromJSON(const QString& jsonPath);
+
+    /**
+     * @brief Компилирует JSON-источник напрямую в бинарный файл.
+     * Главы выделяются из JSON пакетами; разбор, сжатие и шифрование глав
+     * пакета выполняются параллельно в глобальном пуле потоков, а сегменты
+     * записываются в исходном порядке. Файл побайтно совпадает с результатом
+     * saveCourseToBinary() для того же курса. Исключение - шифр AES-GCM:
+     * идентификатор файла и nonce глав случайны, поэтому совпадает только
+     * структура файла.
+     * Пиковая память ограничена двумя пакетами глав. Скорость выводится в лог
+     * в МБ/с.
+     * @param jsonPath Путь к JSON файлу с данными курса
+     * @param binPath Путь к бинарному файлу для сохранения
+     * @param key Ключ для шифрования данных
+     * @param codec Кодек сжатия глав
+     * @param cipher Шифр файла
+     * @return true если записана хотя бы одна глава
+     */
+    static bool compileCourseFromJSON(const QString& jsonPath, const QString& binPath, const QString& key,
+                                      CourseFormat::Codec codec = CourseFormat::DEFAULT_CODEC,
+                                      CourseFormat::Cipher cipher = CourseFormat::Cipher::Xor);
     
     /**
-     * @brief Сохраняет курс в зашифрованный бинарный файл.
+     * @brief Сохраняет курс в зашифрованный бинарный файл формата v2.
+     * Каждая глава записывается отдельным сегментом, что позволяет
+     * читать главы по одной (см. CourseView).
      * @param course Объект курса для сохранения
      * @param binPath Путь к бинарному файлу для сохранения
      * @param key Ключ для шифрования данных
+     * @param codec Кодек сжатия глав
+     * @param cipher Шифр файла
      * @return true если сохранение прошло успешно, false в противном случае
      */
-    static bool saveCourseToBinary(const Course& course, const QString& binPath, const QString& key);
+    static bool saveCourseToBinary(const Course& course, const QString& binPath, const QString& key,
+                                   CourseFormat::Codec codec = CourseFormat::DEFAULT_CODEC,
+                                   CourseFormat::Cipher cipher = CourseFormat::Cipher::Xor);
     
+    /**
+     * @brief Сохраняет курс в формате v1: весь курс одним зашифрованным блоком.
+     * Нужен только для преобразования файлов в старый формат (coursec convert).
+     * @param course Объект курса для сохранения
+     * @param binPath Путь к бинарному файлу для сохранения
+     * @param key Ключ для шифрования данных
+     * @return true если сохранение прошло успешно
+     */
+    static bool saveCourseToLegacyBinary(const Course& course, const QString& binPath, const QString& key);
+
     /**
      * @brief Загружает курс из зашифрованного бинарного файла.
+     * Поддерживаются форматы v1 и v2; главы v2 расшифровываются параллельно.
      * @param binPath Путь к бинарному файлу
      * @param key Ключ для расшифровки данных
      * @return Объект Course с загруженными данными
@@ -37,7 +78,8 @@ public:
     static Course loadCourseFromBinary(const QString& binPath, const QString& key);
 
 private:
-    static const quint32 MAGIC_NUMBER = 0x434F5253; // "CORS" in hex
+    static Course loadCourseFromContainer(QFile& file, const QString& key);
+
     CourseManager() = delete;
 };
 
@@ -0,0 +1,113 @@
+#include "CourseVerifier.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QtConcurrent>
+#include <functional>
+
+bool CourseVerifier::quickCheck(const QString& binPath, CourseFormat::Header* header, QString* errorString) {
+    QElapsedTimer timer;
+    timer.start();
+
+    QString error;
+    CourseFormat::Header fileHeader;
+    QList<CourseFormat::ChapterEntry> entries;
+
+    QFile file(binPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = QString("Cannot open course file: %1").arg(binPath);
+    } else if (!CourseFormat::readHeader(&file, fileHeader)) {
+        error = QString("Invalid course header: %1").arg(binPath);
+    } else if (!CourseFormat::readIndex(&file, fileHeader, entries)) {
+        error = QString("Invalid course index: %1").arg(binPath);
+    } else if (entries.isEmpty()) {
+        error = QString("Course file has no chapters: %1").arg(binPath);
+    }
+
+    if (header) {
+        *header = fileHeader;
+    }
+    if (errorString) {
+        *errorString = error;
+    }
+    if (!error.isEmpty()) {
+        return false;
+    }
+
+    qDebug() << "Course file quick check passed in" << timer.nsecsElapsed() / 1000 << "us,"
+             << entries.size() << "chapters, revision" << fileHeader.revision;
+    return true;
+}
+
+CourseVerifier::Report CourseVerifier::deepVerify(const QString& binPath, const QString& key) {
+    Report report;
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile file(binPath);
+    CourseFormat::Header header;
+    QList<CourseFormat::ChapterEntry> entries;
+    if (!file.open(QIODevice::ReadOnly) || !CourseFormat::readHeader(&file, header)
+        || !CourseFormat::readIndex(&file, header, entries)) {
+        report.errorString = QString("Invalid course header or index: %1").arg(binPath);
+        return report;
+    }
+
+    report.headerValid = true;
+    report.revision = header.revision;
+    report.chapterCount = entries.size();
+
+    // Сегменты читаются из отображения файла без копирования; если отобразить
+    // файл нельзя, каждая задача читает свой сегмент через отдельный QFile
+    uchar* mapped = file.map(0, file.size());
+
+    QList<int> indexes;
+    indexes.reserve(entries.size());
+    for (int i = 0; i < entries.size(); ++i) {
+        indexes.append(i);
+    }
+
+    const std::function<bool(const int&)> verifyChapter = [&](const int& index) {
+        const CourseFormat::ChapterEntry& entry = entries[index];
+        QByteArray segment;
+        if (mapped) {
+            segment = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped) + entry.offset,
+                                              int(entry.length));
+        } else {
+            QFile segmentFile(binPath);
+            if (!segmentFile.open(QIODevice::ReadOnly) || !segmentFile.seek(qint64(entry.offset))) {
+                return false;
+            }
+            segment = segmentFile.read(entry.length);
+        }
+
+        if (!CourseFormat::checkSegment(segment.constData(), segment.size(), entry)) {
+            return false;
+        }
+
+        Chapter chapter;
+        return CourseFormat::decodeChapter(std::move(segment), key, entry, chapter);
+    };
+
+    const QList<bool> results = QtConcurrent::blockingMapped<QList<bool>>(indexes, verifyChapter);
+    for (int i = 0; i < results.size(); ++i) {
+        if (results[i]) {
+            report.bytesChecked += entries[i].length;
+        } else {
+            report.corruptedChapters.append(i);
+        }
+    }
+
+    if (mapped) {
+        file.unmap(mapped);
+    }
+
+    report.elapsedMs = timer.elapsed();
+    if (!report.corruptedChapters.isEmpty()) {
+        report.errorString = QString("%1 of %2 chapter segments are corrupted")
+                                 .arg(report.corruptedChapters.size())
+                                 .arg(report.chapterCount);
+        qWarning() << report.errorString << "in" << binPath;
+    }
+    return report;
+}
@@ -0,0 +1,59 @@
+#ifndef COURSEVERIFIER_H
+#define COURSEVERIFIER_H
+
+#include <QList>
+#include <QString>
+#include "CourseFormat.h"
+
+/**
+ * @brief Проверка целостности course.bin по контрольным суммам.
+ *
+ * Быстрая проверка читает только заголовок и таблицу глав и подходит для
+ * каждого запуска: её время не зависит от размера глав. Глубокая проверка
+ * сверяет CRC32C всех сегментов и декодирует их параллельно в глобальном
+ * пуле потоков.
+ */
+class CourseVerifier
+{
+public:
+    /**
+     * @brief Результат глубокой проверки.
+     */
+    struct Report {
+        bool headerValid = false;      // заголовок и таблица глав корректны
+        quint16 revision = 0;          // ревизия формата файла
+        int chapterCount = 0;
+        QList<int> corruptedChapters;  // индексы глав с ошибкой CRC или декодирования
+        qint64 bytesChecked = 0;
+        qint64 elapsedMs = 0;
+        QString errorString;
+
+        bool isValid() const { return headerValid && corruptedChapters.isEmpty(); }
+    };
+
+    /**
+     * @brief Быстрая проверка: заголовок, слот индекса, число глав и CRC32C таблицы.
+     * Сегменты глав не читаются и не расшифровываются.
+     * @param binPath Путь к файлу курса
+     * @param header Прочитанный заголовок (если не nullptr)
+     * @param errorString Описание ошибки (если не nullptr)
+     * @return true если файл формата v2 с корректной таблицей хотя бы из одной главы
+     */
+    static bool quickCheck(const QString& binPath, CourseFormat::Header* header = nullptr,
+                           QString* errorString = nullptr);
+
+    /**
+     * @brief Глубокая проверка всех сегментов.
+     * Сверяется CRC32C каждого сегмента, затем сегмент расшифровывается
+     * и десериализуется.
+     * @param binPath Путь к файлу курса
+     * @param key Ключ шифрования
+     * @return Отчёт о проверке
+     */
+    static Report deepVerify(const QString& binPath, const QString& key);
+
+private:
+    CourseVerifier() = delete;
+};
+
+#endif // COURSEVERIFIER_H
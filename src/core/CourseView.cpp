@@ -0,0 +1,386 @@
+#include "CourseView.h"
+#include <QDebug>
+#include <QtEndian>
+#include "CourseManager.h"
+
+/**
+ * @brief Последовательное чтение полей QDataStream из зашифрованного сегмента.
+ * Расшифровывает только те байты, которые действительно читаются.
+ */
+class CourseView::Cursor
+{
+public:
+    Cursor()
+        : m_segment(nullptr), m_length(0), m_pos(0), m_valid(false) {}
+
+    Cursor(const uchar* segment, quint32 length, const XorKeyStream& keyStream)
+        : m_segment(segment), m_length(length), m_keyStream(keyStream)
+        , m_pos(0), m_valid(segment != nullptr) {
+        m_keyStream.seek(0);
+    }
+
+    bool isValid() const { return m_valid; }
+
+    qint32 readInt32() {
+        uchar bytes[4];
+        decode(bytes, sizeof(bytes));
+        return m_valid ? qFromBigEndian<qint32>(bytes) : 0;
+    }
+
+    /**
+     * @brief Читает размер контейнера (в Qt 6.7+ возможна 64-битная форма).
+     * Каждый элемент занимает в сегменте не меньше MIN_ELEMENT_SIZE байт,
+     * поэтому размер, не помещающийся в остаток сегмента, означает повреждение.
+     */
+    qint64 readSize() {
+        qint64 size = quint32(readInt32());
+        if (size == EXTENDED_SIZE) {
+            uchar bytes[8];
+            decode(bytes, sizeof(bytes));
+            size = m_valid ? qFromBigEndian<qint64>(bytes) : 0;
+        }
+        if (!m_valid || size < 0 || size > remaining() / MIN_ELEMENT_SIZE) {
+            m_valid = false;
+            return 0;
+        }
+        return size;
+    }
+
+    QString readString() {
+        const qint64 byteCount = readStringSize();
+        if (!m_valid || byteCount < 0) {
+            return QString();
+        }
+
+        // Размер проверен в readStringSize() до выделения буфера.
+        // Строки в QDataStream хранятся в UTF-16 big-endian
+        QByteArray utf16(byteCount, Qt::Uninitialized);
+        decode(reinterpret_cast<uchar*>(utf16.data()), byteCount);
+        if (!m_valid) {
+            return QString();
+        }
+
+        QString result(byteCount / 2, Qt::Uninitialized);
+        QChar* out = result.data();
+        for (qint64 i = 0; i < byteCount / 2; ++i) {
+            out[i] = QChar(qFromBigEndian<quint16>(utf16.constData() + i * 2));
+        }
+        return result;
+    }
+
+    void skipString() {
+        const qint64 byteCount = readStringSize();
+        if (byteCount > 0) {
+            skip(byteCount);
+        }
+    }
+
+    QStringList readStringList() {
+        QStringList result;
+        const qint64 count = readSize();
+        for (qint64 i = 0; m_valid && i < count; ++i) {
+            result.append(readString());
+        }
+        return result;
+    }
+
+    void skipStringList() {
+        const qint64 count = readSize();
+        for (qint64 i = 0; m_valid && i < count; ++i) {
+            skipString();
+        }
+    }
+
+    void skipQuestion() {
+        skipString();
+        skipStringList();
+        skip(sizeof(qint32));
+    }
+
+private:
+    static const quint32 NULL_STRING = 0xffffffff;
+    static const quint32 EXTENDED_SIZE = 0xfffffffe;
+    // Наименьший элемент контейнера - пустая строка (только размер)
+    static const qint64 MIN_ELEMENT_SIZE = 4;
+
+    qint64 remaining() const {
+        return qint64(m_length) - m_pos;
+    }
+
+    /**
+     * @brief Читает размер строки в байтах; -1 для null-строки.
+     * Размер берётся из файла, поэтому нечётный или выходящий за сегмент
+     * размер делает курсор недействительным.
+     */
+    qint64 readStringSize() {
+        qint64 size = quint32(readInt32());
+        if (!m_valid || size == NULL_STRING) {
+            return -1;
+        }
+        if (size == EXTENDED_SIZE) {
+            uchar bytes[8];
+            decode(bytes, sizeof(bytes));
+            size = m_valid ? qFromBigEndian<qint64>(bytes) : -1;
+        }
+        if (!m_valid || size < 0 || size % 2 != 0 || size > remaining()) {
+            m_valid = false;
+            return -1;
+        }
+        return size;
+    }
+
+    void skip(qint64 count) {
+        if (count > remaining()) {
+            m_valid = false;
+            return;
+        }
+        m_pos += count;
+    }
+
+    void decode(uchar* dest, qint64 count) {
+        if (!m_valid || count > remaining()) {
+            m_valid = false;
+            return;
+        }
+
+        // Ключ применяется циклически от начала сегмента; после skip()
+        // ключевой поток переводится на текущую позицию
+        if (m_keyStream.position() != m_pos) {
+            m_keyStream.seek(m_pos);
+        }
+        m_keyStream.apply(reinterpret_cast<const char*>(m_segment + m_pos), reinterpret_cast<char*>(dest), count);
+        m_pos += count;
+    }
+
+    const uchar* m_segment;
+    quint32 m_length;
+    XorKeyStream m_keyStream;
+    qint64 m_pos;
+    bool m_valid;
+};
+
+CourseView::CourseView()
+    : m_data(nullptr), m_legacy(false), m_unpackedIndex(-1) {
+}
+
+CourseView::~CourseView() {
+    close();
+}
+
+bool CourseView::open(const QString& binPath, const QString& key) {
+    close();
+
+    if (CourseFormat::readMagic(binPath) != CourseFormat::MAGIC_NUMBER_V2) {
+        m_legacyCourse = CourseManager::loadCourseFromBinary(binPath, key);
+        m_legacy = !m_legacyCourse.chapters.isEmpty();
+        return m_legacy;
+    }
+
+    m_file.setFileName(binPath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Cannot open binary file for reading:" << binPath;
+        return false;
+    }
+
+    CourseFormat::Header header;
+    if (!CourseFormat::readHeader(&m_file, header) || !CourseFormat::readIndex(&m_file, header, m_entries)) {
+        close();
+        return false;
+    }
+
+    m_data = m_file.map(0, m_file.size());
+    if (!m_data) {
+        // Отображение недоступно (например, на некоторых сетевых ФС) -
+        // загружаем курс целиком, как для v1
+        qWarning() << "Cannot map course file, falling back to full load:" << m_file.errorString();
+        close();
+        m_legacyCourse = CourseManager::loadCourseFromBinary(binPath, key);
+        m_legacy = !m_legacyCourse.chapters.isEmpty();
+        return m_legacy;
+    }
+
+    m_key = key;
+    m_keyStream = XorKeyStream(key);
+    return !m_entries.isEmpty();
+}
+
+void CourseView::close() {
+    if (m_data) {
+        m_file.unmap(const_cast<uchar*>(m_data));
+        m_data = nullptr;
+    }
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_key.clear();
+    m_keyStream = XorKeyStream();
+    m_entries.clear();
+    m_unpackedIndex = -1;
+    m_unpacked.clear();
+    m_legacy = false;
+    m_legacyCourse = Course();
+}
+
+bool CourseView::isOpen() const {
+    return m_legacy || m_data != nullptr;
+}
+
+int CourseView::chapterCount() const {
+    return m_legacy ? m_legacyCourse.chapters.size() : m_entries.size();
+}
+
+const Question* CourseView::legacyQuestion(int chapterIndex, int questionIndex) const {
+    if (questionIndex < 0 || questionIndex >= questionCount(chapterIndex)) {
+        return nullptr;
+    }
+    return &m_legacyCourse.chapters[chapterIndex].questions[questionIndex];
+}
+
+CourseView::Cursor CourseView::cursorAt(int chapterIndex) const {
+    if (!m_data || chapterIndex < 0 || chapterIndex >= m_entries.size()) {
+        return Cursor();
+    }
+
+    const CourseFormat::ChapterEntry& entry = m_entries[chapterIndex];
+    if (entry.codec == CourseFormat::Codec::None && entry.cipher == CourseFormat::Cipher::Xor) {
+        return Cursor(m_data + entry.offset, entry.length, m_keyStream);
+    }
+
+    // Сжатую главу и главу AES-GCM (тег проверяется по всему сегменту) нельзя
+    // читать по полям - декодируем её целиком и держим последнюю в кэше
+    if (m_unpackedIndex != chapterIndex) {
+        const QByteArray segment = QByteArray::fromRawData(
+            reinterpret_cast<const char*>(m_data + entry.offset), qsizetype(entry.length));
+        if (!CourseFormat::decodeSegment(segment, m_key, entry, m_unpacked)) {
+            qWarning() << "Corrupted chapter segment" << chapterIndex;
+            m_unpackedIndex = -1;
+            return Cursor();
+        }
+        m_unpackedIndex = chapterIndex;
+    }
+    return Cursor(reinterpret_cast<const uchar*>(m_unpacked.constData()), quint32(m_unpacked.size()), XorKeyStream());
+}
+
+bool CourseView::seekQuestion(Cursor& cursor, int chapterIndex, int questionIndex) const {
+    cursor = cursorAt(chapterIndex);
+    cursor.readInt32();
+    cursor.skipString();
+    cursor.skipString();
+
+    const qint64 count = cursor.readSize();
+    if (!cursor.isValid() || questionIndex < 0 || questionIndex >= count) {
+        return false;
+    }
+
+    for (int i = 0; i < questionIndex && cursor.isValid(); ++i) {
+        cursor.skipQuestion();
+    }
+    return cursor.isValid();
+}
+
+int CourseView::chapterId(int chapterIndex) const {
+    if (m_legacy) {
+        return chapterIndex >= 0 && chapterIndex < chapterCount() ? m_legacyCourse.chapters[chapterIndex].id : 0;
+    }
+
+    Cursor cursor = cursorAt(chapterIndex);
+    return cursor.readInt32();
+}
+
+QString CourseView::chapterTitle(int chapterIndex) const {
+    if (m_legacy) {
+        return chapterIndex >= 0 && chapterIndex < chapterCount() ? m_legacyCourse.chapters[chapterIndex].title : QString();
+    }
+
+    Cursor cursor = cursorAt(chapterIndex);
+    cursor.readInt32();
+    return cursor.readString();
+}
+
+QString CourseView::chapterContent(int chapterIndex) const {
+    if (m_legacy) {
+        return chapterIndex >= 0 && chapterIndex < chapterCount() ? m_legacyCourse.chapters[chapterIndex].content : QString();
+    }
+
+    Cursor cursor = cursorAt(chapterIndex);
+    cursor.readInt32();
+    cursor.skipString();
+    return cursor.readString();
+}
+
+int CourseView::questionCount(int chapterIndex) const {
+    if (m_legacy) {
+        return chapterIndex >= 0 && chapterIndex < chapterCount() ? m_legacyCourse.chapters[chapterIndex].questions.size() : 0;
+    }
+
+    Cursor cursor = cursorAt(chapterIndex);
+    cursor.readInt32();
+    cursor.skipString();
+    cursor.skipString();
+    const qint64 count = cursor.readSize();
+    return cursor.isValid() ? int(count) : 0;
+}
+
+QString CourseView::questionText(int chapterIndex, int questionIndex) const {
+    if (m_legacy) {
+        const Question* question = legacyQuestion(chapterIndex, questionIndex);
+        return question ? question->q_text : QString();
+    }
+
+    Cursor cursor;
+    if (!seekQuestion(cursor, chapterIndex, questionIndex)) {
+        return QString();
+    }
+    return cursor.readString();
+}
+
+QStringList CourseView::questionOptions(int chapterIndex, int questionIndex) const {
+    if (m_legacy) {
+        const Question* question = legacyQuestion(chapterIndex, questionIndex);
+        return question ? question->options : QStringList();
+    }
+
+    Cursor cursor;
+    if (!seekQuestion(cursor, chapterIndex, questionIndex)) {
+        return QStringList();
+    }
+    cursor.skipString();
+    return cursor.readStringList();
+}
+
+int CourseView::correctIndex(int chapterIndex, int questionIndex) const {
+    if (m_legacy) {
+        const Question* question = legacyQuestion(chapterIndex, questionIndex);
+        return question ? question->correct_index : -1;
+    }
+
+    Cursor cursor;
+    if (!seekQuestion(cursor, chapterIndex, questionIndex)) {
+        return -1;
+    }
+    cursor.skipString();
+    cursor.skipStringList();
+    const qint32 correct = cursor.readInt32();
+    return cursor.isValid() ? correct : -1;
+}
+
+Chapter CourseView::chapter(int chapterIndex) const {
+    if (m_legacy) {
+        return chapterIndex >= 0 && chapterIndex < chapterCount() ? m_legacyCourse.chapters[chapterIndex] : Chapter();
+    }
+
+    if (!m_data || chapterIndex < 0 || chapterIndex >= m_entries.size()) {
+        return Chapter();
+    }
+
+    const CourseFormat::ChapterEntry& entry = m_entries[chapterIndex];
+    const QByteArray segment = QByteArray::fromRawData(
+        reinterpret_cast<const char*>(m_data + entry.offset), qsizetype(entry.length));
+
+    Chapter result;
+    if (!CourseFormat::decodeChapter(segment, m_key, entry, result)) {
+        qWarning() << "Corrupted chapter segment" << chapterIndex;
+        return Chapter();
+    }
+    return result;
+}
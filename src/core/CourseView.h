@@ -0,0 +1,101 @@
+#ifndef COURSEVIEW_H
+#define COURSEVIEW_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include "models/Structures.h"
+#include "CourseFormat.h"
+#include "CryptoUtils.h"
+
+/**
+ * @brief Представление курса только для чтения поверх отображённого в память файла.
+ *
+ * Файл v2 отображается через QFile::map() целиком, но в память процесса
+ * попадают только страницы, к которым обращается UI. Каждое поле главы
+ * (заголовок, текст, вопросы, варианты ответов) расшифровывается прямо из
+ * отображения в момент запроса: XOR-шифр позиционный, поэтому любой
+ * фрагмент сегмента декодируется независимо от остальных.
+ * Сжатые главы и главы файлов AES-GCM так читать нельзя: такая глава
+ * декодируется целиком при первом обращении, и последняя декодированная
+ * глава кэшируется.
+ * По умолчанию (CourseFormat::DEFAULT_CODEC) главы не сжимаются, поэтому
+ * обычный путь - чтение по полям.
+ *
+ * Файлы v1 не поддерживают произвольный доступ и загружаются целиком.
+ */
+class CourseView
+{
+public:
+    CourseView();
+    ~CourseView();
+
+    /**
+     * @brief Открывает и отображает в память бинарный файл курса.
+     * @param binPath Путь к бинарному файлу
+     * @param key Ключ для расшифровки данных
+     * @return true если файл открыт и содержит хотя бы одну главу
+     */
+    bool open(const QString& binPath, const QString& key);
+
+    /**
+     * @brief Снимает отображение и закрывает файл.
+     */
+    void close();
+
+    bool isOpen() const;
+
+    /**
+     * @brief Возвращает количество глав без их расшифровки.
+     */
+    int chapterCount() const;
+
+    int chapterId(int chapterIndex) const;
+    QString chapterTitle(int chapterIndex) const;
+    QString chapterContent(int chapterIndex) const;
+
+    int questionCount(int chapterIndex) const;
+    QString questionText(int chapterIndex, int questionIndex) const;
+    QStringList questionOptions(int chapterIndex, int questionIndex) const;
+    int correctIndex(int chapterIndex, int questionIndex) const;
+
+    /**
+     * @brief Расшифровывает главу целиком.
+     * @param chapterIndex Индекс главы
+     * @return Глава или пустой объект Chapter при ошибке
+     */
+    Chapter chapter(int chapterIndex) const;
+
+    CourseView(const CourseView&) = delete;
+    CourseView& operator=(const CourseView&) = delete;
+
+private:
+    class Cursor;
+
+    /**
+     * @brief Устанавливает курсор на начало вопроса.
+     * @return false если главы или вопроса с таким индексом нет
+     */
+    bool seekQuestion(Cursor& cursor, int chapterIndex, int questionIndex) const;
+
+    Cursor cursorAt(int chapterIndex) const;
+    const Question* legacyQuestion(int chapterIndex, int questionIndex) const;
+
+    QFile m_file;
+    const uchar* m_data;
+    QString m_key;
+    XorKeyStream m_keyStream;
+    QList<CourseFormat::ChapterEntry> m_entries;
+
+    // Курс в формате v1 хранится в памяти целиком
+    bool m_legacy;
+    Course m_legacyCourse;
+
+    // Последняя распакованная сжатая глава
+    mutable int m_unpackedIndex;
+    mutable QByteArray m_unpacked;
+};
+
+#endif // COURSEVIEW_H
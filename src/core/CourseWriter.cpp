@@ -0,0 +1,230 @@
+#include "CourseWriter.h"
+#include <QDebug>
+#include <QRandomGenerator>
+
+CourseWriter::CourseWriter()
+    : m_offset(0), m_peakQueuedBytes(0), m_codec(CourseFormat::DEFAULT_CODEC)
+    , m_cipher(CourseFormat::Cipher::Xor), m_fileId(0) {
+}
+
+CourseWriter::~CourseWriter() {
+    cancel();
+}
+
+void CourseWriter::setCodec(CourseFormat::Codec codec) {
+    m_codec = codec;
+}
+
+CourseFormat::Codec CourseWriter::codec() const {
+    return m_codec;
+}
+
+void CourseWriter::setCipher(CourseFormat::Cipher cipher) {
+    m_cipher = cipher;
+}
+
+CourseFormat::Cipher CourseWriter::cipher() const {
+    return m_cipher;
+}
+
+void CourseWriter::setFileId(quint64 fileId) {
+    m_fileId = fileId;
+}
+
+quint64 CourseWriter::fileId() const {
+    return m_header.fileId;
+}
+
+bool CourseWriter::open(const QString& binPath, const QString& key) {
+    m_file.setFileName(binPath);
+    if (!m_file.open(QIODevice::WriteOnly)) {
+        m_errorString = QString("Cannot open binary file for writing: %1 (%2)").arg(binPath, m_file.errorString());
+        qWarning() << m_errorString;
+        return false;
+    }
+
+    m_key = key;
+    m_entries.clear();
+    m_errorString.clear();
+
+    // Заголовок пишется дважды: сначала с пустыми слотами индекса,
+    // затем с действующим слотом в commit()
+    m_header = CourseFormat::Header();
+    m_header.magic = CourseFormat::MAGIC_NUMBER_V2;
+    m_header.revision = CourseFormat::FORMAT_REVISION;
+    m_header.cipher = m_cipher;
+    // XOR-файлы без идентификатора остаются побайтно воспроизводимыми
+    if (m_cipher == CourseFormat::Cipher::AesGcm) {
+        while (m_fileId == 0) {
+            m_fileId = QRandomGenerator::system()->generate64();
+        }
+        m_header.fileId = m_fileId;
+    }
+    if (!CourseFormat::writeHeader(&m_file, m_header)) {
+        m_errorString = QString("Failed to write course header: %1").arg(m_file.errorString());
+        qWarning() << m_errorString;
+        m_file.cancelWriting();
+        m_file.commit();
+        return false;
+    }
+
+    // Дальше с файлом работает только поток записи, до finishWriting()
+    m_offset = m_file.pos();
+    m_peakQueuedBytes = 0;
+    m_writeFailed.storeRelaxed(0);
+    m_writeError.clear();
+    m_queue.reset(new BoundedQueue<QByteArray>(QUEUE_CAPACITY));
+    m_writerThread.reset(QThread::create([this]() { writeLoop(); }));
+    m_writerThread->start();
+    return true;
+}
+
+void CourseWriter::writeLoop() {
+    QByteArray segment;
+    while (m_queue->pop(segment)) {
+        // После ошибки очередь вычитывается вхолостую, чтобы не блокировать производителя
+        if (m_writeFailed.loadAcquire()) {
+            continue;
+        }
+
+        for (qint64 done = 0; done < segment.size(); ) {
+            const qint64 chunk = qMin(WRITE_CHUNK_SIZE, qint64(segment.size()) - done);
+            if (m_file.write(segment.constData() + done, chunk) != chunk) {
+                m_writeError = QString("Failed to write chapter segment: %1").arg(m_file.errorString());
+                m_writeFailed.storeRelease(1);
+                break;
+            }
+            done += chunk;
+        }
+        segment.clear();
+    }
+}
+
+bool CourseWriter::finishWriting() {
+    if (m_writerThread.isNull()) {
+        return !m_writeFailed.loadAcquire();
+    }
+
+    m_queue->close();
+    m_writerThread->wait();
+    m_peakQueuedBytes = m_queue->peakSize();
+    m_writerThread.reset();
+    m_queue.reset();
+
+    if (m_writeFailed.loadAcquire()) {
+        m_errorString = m_writeError;
+        qWarning() << m_errorString;
+        return false;
+    }
+    return true;
+}
+
+bool CourseWriter::addChapter(const Chapter& chapter) {
+    if (!m_file.isOpen()) {
+        return false;
+    }
+
+    // Каждая глава сжимается и шифруется независимо, чтобы её можно было прочитать отдельно
+    CourseFormat::ChapterEntry entry;
+    const QByteArray segment = CourseFormat::encodeChapter(chapter, m_key, m_codec, m_cipher, m_header.fileId,
+                                                           quint32(m_entries.size()), entry);
+    if (segment.isEmpty()) {
+        m_errorString = QString("Failed to encrypt chapter %1").arg(chapter.id);
+        return false;
+    }
+    return addSegment(segment, entry);
+}
+
+bool CourseWriter::addSegment(const QByteArray& segment, const CourseFormat::ChapterEntry& sourceEntry) {
+    if (!m_file.isOpen()) {
+        return false;
+    }
+
+    if (m_writeFailed.loadAcquire() || m_queue.isNull()) {
+        m_errorString = "Course file writer has failed";
+        return false;
+    }
+
+    // Тег AES-GCM привязан к файлу и номеру главы: чужой сегмент не расшифруется
+    if (m_cipher == CourseFormat::Cipher::AesGcm
+        && (sourceEntry.fileId != m_header.fileId || sourceEntry.index != quint32(m_entries.size()))) {
+        m_errorString = QString("Chapter segment was encrypted for another file or position: %1")
+                            .arg(sourceEntry.index);
+        qWarning() << m_errorString;
+        return false;
+    }
+
+    // Смещение известно заранее: поток записи пишет сегменты строго по порядку
+    CourseFormat::ChapterEntry entry = sourceEntry;
+    entry.offset = quint64(m_offset);
+    entry.length = quint32(segment.size());
+
+    if (!m_queue->push(segment, segment.size())) {
+        m_errorString = "Course file writer queue is closed";
+        qWarning() << m_errorString;
+        return false;
+    }
+
+    m_offset += segment.size();
+    m_entries.append(entry);
+    return true;
+}
+
+bool CourseWriter::commit() {
+    if (!m_file.isOpen()) {
+        return false;
+    }
+    if (!finishWriting()) {
+        cancel();
+        return false;
+    }
+
+    qDebug() << "Course segments written:" << m_offset << "bytes, peak queued" << m_peakQueuedBytes << "bytes";
+
+    m_header.generation = 1;
+    m_header.activeSlot = 0;
+    if (!CourseFormat::writeIndex(&m_file, m_entries, m_header)) {
+        m_errorString = QString("Failed to write course index: %1").arg(m_file.errorString());
+        qWarning() << m_errorString;
+        cancel();
+        return false;
+    }
+    if (!CourseFormat::writeHeader(&m_file, m_header)) {
+        m_errorString = QString("Failed to write course header: %1").arg(m_file.errorString());
+        qWarning() << m_errorString;
+        cancel();
+        return false;
+    }
+
+    if (!m_file.commit()) {
+        m_errorString = QString("Cannot write binary file: %1 (%2)").arg(m_file.fileName(), m_file.errorString());
+        qWarning() << m_errorString;
+        return false;
+    }
+    return true;
+}
+
+void CourseWriter::cancel() {
+    finishWriting();
+    if (m_file.isOpen()) {
+        m_file.cancelWriting();
+        m_file.commit(); // после cancelWriting() удаляет временный файл
+    }
+    m_entries.clear();
+}
+
+int CourseWriter::chapterCount() const {
+    return m_entries.size();
+}
+
+qint64 CourseWriter::bytesWritten() const {
+    return m_file.isOpen() ? m_offset : 0;
+}
+
+QString CourseWriter::errorString() const {
+    return m_errorString;
+}
+
+qint64 CourseWriter::peakQueuedBytes() const {
+    return m_peakQueuedBytes;
+}
@@ -0,0 +1,143 @@
+#ifndef COURSEWRITER_H
+#define COURSEWRITER_H
+
+#include <QAtomicInt>
+#include <QList>
+#include <QSaveFile>
+#include <QScopedPointer>
+#include <QString>
+#include <QThread>
+#include "models/Structures.h"
+#include "BoundedQueue.h"
+#include "CourseFormat.h"
+
+/**
+ * @brief Потоковая запись курса в формат v2.
+ * Главы добавляются по одной: вызывающий поток сериализует, сжимает и
+ * шифрует главу, а отдельный поток записи сбрасывает готовые сегменты на
+ * диск блоками по WRITE_CHUNK_SIZE. Потоки связаны очередью ёмкостью
+ * QUEUE_CAPACITY, поэтому кодирование и запись перекрываются, а пик памяти
+ * не зависит от размера курса. Таблица глав дописывается в commit(),
+ * а файл заменяется атомарно (QSaveFile).
+ */
+class CourseWriter
+{
+public:
+    CourseWriter();
+
+    /**
+     * @brief Отменяет незавершённую запись.
+     */
+    ~CourseWriter();
+
+    /**
+     * @brief Начинает запись нового файла курса.
+     * @param binPath Путь к бинарному файлу
+     * @param key Ключ для шифрования данных
+     * @return true если временный файл создан
+     */
+    bool open(const QString& binPath, const QString& key);
+
+    /**
+     * @brief Задаёт кодек сжатия для последующих глав.
+     * По умолчанию используется CourseFormat::DEFAULT_CODEC.
+     */
+    void setCodec(CourseFormat::Codec codec);
+    CourseFormat::Codec codec() const;
+
+    /**
+     * @brief Задаёт шифр файла. Вызывается до open().
+     * По умолчанию используется CourseFormat::Cipher::Xor.
+     */
+    void setCipher(CourseFormat::Cipher cipher);
+    CourseFormat::Cipher cipher() const;
+
+    /**
+     * @brief Задаёт идентификатор файла AES-GCM. Вызывается до open().
+     * Нужен при компактификации, чтобы перенести сегменты без повторного
+     * шифрования; по умолчанию open() выбирает случайный идентификатор.
+     */
+    void setFileId(quint64 fileId);
+
+    /**
+     * @brief Идентификатор файла, к которому привязаны теги глав (после open()).
+     */
+    quint64 fileId() const;
+
+    /**
+     * @brief Шифрует очередную главу и ставит её в очередь записи.
+     * Блокируется, если очередь заполнена.
+     * @return true если глава принята
+     */
+    bool addChapter(const Chapter& chapter);
+
+    /**
+     * @brief Записывает уже зашифрованный сегмент главы как есть.
+     * Используется при компактификации, чтобы не шифровать главы повторно,
+     * и при параллельной компиляции, где главы шифруются в других потоках.
+     * @param segment Сегмент из другого файла
+     * @param sourceEntry Запись таблицы сегмента (кодек и исходная длина);
+     * сегмент должен быть зашифрован шифром этого файла, а для AES-GCM -
+     * для fileId() и очередного номера главы
+     * @return true если сегмент принят
+     */
+    bool addSegment(const QByteArray& segment, const CourseFormat::ChapterEntry& sourceEntry);
+
+    /**
+     * @brief Дожидается записи всех сегментов, дописывает таблицу глав
+     * и заменяет целевой файл.
+     * @return true если файл успешно сохранён
+     */
+    bool commit();
+
+    /**
+     * @brief Отменяет запись, целевой файл остаётся без изменений.
+     */
+    void cancel();
+
+    int chapterCount() const;
+    qint64 bytesWritten() const;
+    QString errorString() const;
+
+    /**
+     * @brief Наибольший объём сегментов, ожидавших записи, в байтах.
+     */
+    qint64 peakQueuedBytes() const;
+
+    // Сегменты сверх этого объёма ждут, пока поток записи освободит очередь
+    static const qint64 QUEUE_CAPACITY = 8 * 1024 * 1024;
+    // Размер блока одного вызова write()
+    static const qint64 WRITE_CHUNK_SIZE = 1024 * 1024;
+
+    CourseWriter(const CourseWriter&) = delete;
+    CourseWriter& operator=(const CourseWriter&) = delete;
+
+private:
+    /**
+     * @brief Цикл потока записи: извлекает сегменты из очереди и пишет их в файл.
+     */
+    void writeLoop();
+
+    /**
+     * @brief Закрывает очередь и дожидается потока записи.
+     * @return true если все сегменты записаны без ошибок
+     */
+    bool finishWriting();
+
+    QSaveFile m_file;
+    QScopedPointer<BoundedQueue<QByteArray>> m_queue;
+    QScopedPointer<QThread> m_writerThread;
+    QAtomicInt m_writeFailed;
+    QString m_writeError;    // заполняется потоком записи, читается после его завершения
+    qint64 m_offset;
+    qint64 m_peakQueuedBytes;
+    QString m_key;
+    CourseFormat::Codec m_codec;
+    CourseFormat::Cipher m_cipher;
+    quint64 m_fileId;
+    CourseFormat::Header m_header;
+    QList<CourseFormat::ChapterEntry> m_entries;
+    QString m_errorString;
+};
+
+#endif // COURSEWRITER_H
@@ -1,24 +1,442 @@
 #include "CryptoUtils.h"
 #include <QCryptographicHash>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QtConcurrent>
+#include <cstring>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+
+#if defined(Q_PROCESSOR_X86)
+#include <immintrin.h>
+#if defined(Q_CC_MSVC)
+#include <intrin.h>
+#endif
+#endif
+
+namespace {
+
+// Запас развёрнутого ключа: самый длинный шаг ядра (два вектора AVX2)
+const int EXPANDED_KEY_TAIL = 64;
+
+// Все ядра получают развёрнутый ключ expanded[i] = key[i % keySize] длиной
+// keySize + EXPANDED_KEY_TAIL и смещение offset < keySize. Ключевые байты
+// для следующих N байт данных - это expanded[offset .. offset + N).
+// Возвращают новое смещение.
+
+qint64 xorScalar(const uchar* src, uchar* dest, qint64 size,
+                 const uchar* expanded, qint64 keySize, qint64 offset) {
+    for (qint64 i = 0; i < size; ++i) {
+        dest[i] = src[i] ^ expanded[offset];
+        if (++offset == keySize) {
+            offset = 0;
+        }
+    }
+    return offset;
+}
+
+#if defined(Q_PROCESSOR_X86)
+
+#if defined(Q_CC_GNU) || defined(Q_CC_CLANG)
+__attribute__((target("sse2")))
+#endif
+qint64 xorSse2(const uchar* src, uchar* dest, qint64 size,
+               const uchar* expanded, qint64 keySize, qint64 offset) {
+    const qint64 step = 16 % keySize;
+    for (; size >= 16; src += 16, dest += 16, size -= 16) {
+        const __m128i key = _mm_loadu_si128(reinterpret_cast<const __m128i*>(expanded + offset));
+        const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm_xor_si128(data, key));
+        offset += step;
+        if (offset >= keySize) {
+            offset -= keySize;
+        }
+    }
+    return xorScalar(src, dest, size, expanded, keySize, offset);
+}
+
+#if defined(Q_CC_GNU) || defined(Q_CC_CLANG)
+__attribute__((target("avx2")))
+#endif
+qint64 xorAvx2(const uchar* src, uchar* dest, qint64 size,
+               const uchar* expanded, qint64 keySize, qint64 offset) {
+    const qint64 step = 32 % keySize;
+    for (; size >= 32; src += 32, dest += 32, size -= 32) {
+        const __m256i key = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(expanded + offset));
+        const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest), _mm256_xor_si256(data, key));
+        offset += step;
+        if (offset >= keySize) {
+            offset -= keySize;
+        }
+    }
+    return xorScalar(src, dest, size, expanded, keySize, offset);
+}
+
+bool detectAvx2() {
+#if defined(Q_CC_MSVC)
+    int info[4] = {0, 0, 0, 0};
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) { // ОС сохраняет регистры YMM
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0; // EBX.AVX2
+#elif defined(Q_CC_GNU) || defined(Q_CC_CLANG)
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+bool detectSse2() {
+#if defined(Q_PROCESSOR_X86_64)
+    return true; // входит в базовый набор x86-64
+#elif defined(Q_CC_MSVC)
+    int info[4] = {0, 0, 0, 0};
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0; // EDX.SSE2
+#elif defined(Q_CC_GNU) || defined(Q_CC_CLANG)
+    return __builtin_cpu_supports("sse2");
+#else
+    return false;
+#endif
+}
+
+#endif
+
+qint64 runKernel(CryptoUtils::XorKernel kernel, const uchar* src, uchar* dest, qint64 size,
+                 const uchar* expanded, qint64 keySize, qint64 offset) {
+    switch (kernel) {
+#if defined(Q_PROCESSOR_X86)
+    case CryptoUtils::XorKernel::Avx2:
+        return xorAvx2(src, dest, size, expanded, keySize, offset);
+    case CryptoUtils::XorKernel::Sse2:
+        return xorSse2(src, dest, size, expanded, keySize, offset);
+#endif
+    default:
+        return xorScalar(src, dest, size, expanded, keySize, offset);
+    }
+}
+
+} // namespace
 
 QByteArray CryptoUtils::xorEncryptDecrypt(const QByteArray& data, const QString& key) {
     if (data.isEmpty() || key.isEmpty()) {
         return data;
     }
 
-    QByteArray keyBytes = key.toUtf8();
-    QByteArray result = data;
+    // Результат пишется сразу в новый буфер, без копии исходных данных
+    QByteArray result(data.size(), Qt::Uninitialized);
+    XorKeyStream stream(key);
+    stream.apply(data.constData(), result.data(), data.size());
+    return result;
+}
+
+void CryptoUtils::xorInPlace(QByteArray& data, const QString& key) {
+    if (data.isEmpty() || key.isEmpty()) {
+        return;
+    }
+
+    XorKeyStream stream(key);
+    stream.apply(data.data(), data.size());
+}
+
+bool CryptoUtils::isXorKernelSupported(XorKernel kernel) {
+    switch (kernel) {
+    case XorKernel::Scalar:
+        return true;
+#if defined(Q_PROCESSOR_X86)
+    case XorKernel::Sse2: {
+        static const bool sse2 = detectSse2();
+        return sse2;
+    }
+    case XorKernel::Avx2: {
+        static const bool avx2 = detectAvx2();
+        return avx2;
+    }
+#endif
+    default:
+        return false;
+    }
+}
+
+CryptoUtils::XorKernel CryptoUtils::xorKernel() {
+    static const XorKernel kernel = isXorKernelSupported(XorKernel::Avx2) ? XorKernel::Avx2
+                                    : isXorKernelSupported(XorKernel::Sse2) ? XorKernel::Sse2
+                                                                            : XorKernel::Scalar;
+    return kernel;
+}
 
-    // Применение XOR шифрования с циклическим использованием ключа
-    for (int i = 0; i < result.size(); ++i) {
-        result[i] = result[i] ^ keyBytes[i % keyBytes.size()];
+QString CryptoUtils::xorKernelName(XorKernel kernel) {
+    switch (kernel) {
+    case XorKernel::Scalar:
+        return "scalar";
+    case XorKernel::Sse2:
+        return "sse2";
+    case XorKernel::Avx2:
+        return "avx2";
     }
+    return "unknown";
+}
 
-    return result;
+namespace {
+
+QByteArray aesKey(const QString& key) {
+    return QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha256);
+}
+
+const QString PBKDF2_PREFIX = "pbkdf2-sha256";
+const int PBKDF2_SALT_SIZE = 16;
+const int PBKDF2_HASH_SIZE = 32;
+
+QByteArray pbkdf2(const QByteArray& password, const QByteArray& salt, int iterations) {
+    QByteArray derived(PBKDF2_HASH_SIZE, Qt::Uninitialized);
+    if (PKCS5_PBKDF2_HMAC(password.constData(), int(password.size()),
+                          reinterpret_cast<const uchar*>(salt.constData()), int(salt.size()),
+                          iterations, EVP_sha256(), PBKDF2_HASH_SIZE,
+                          reinterpret_cast<uchar*>(derived.data())) != 1) {
+        return QByteArray();
+    }
+    return derived;
+}
+
+// Хеш, с которым сравнивается пароль несуществующего пользователя
+const QString& dummyPasswordHash() {
+    static const QString hash = CryptoUtils::hashPassword(QString(), CryptoUtils::passwordIterations());
+    return hash;
+}
+
+} // namespace
+
+QByteArray CryptoUtils::aesGcmEncrypt(const QByteArray& data, const QString& key, const QByteArray& aad) {
+    const QByteArray keyBytes = aesKey(key);
+    QByteArray sealed(AES_GCM_NONCE_SIZE + data.size() + AES_GCM_TAG_SIZE, Qt::Uninitialized);
+    uchar* nonce = reinterpret_cast<uchar*>(sealed.data());
+    uchar* cipherText = nonce + AES_GCM_NONCE_SIZE;
+    uchar* tag = cipherText + data.size();
+
+    quint32 nonceWords[AES_GCM_NONCE_SIZE / sizeof(quint32)];
+    QRandomGenerator::system()->fillRange(nonceWords);
+    std::memcpy(nonce, nonceWords, AES_GCM_NONCE_SIZE);
+
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    int length = 0;
+    const bool ok = ctx
+        && EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), nullptr, nullptr, nullptr) == 1
+        && EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, AES_GCM_NONCE_SIZE, nullptr) == 1
+        && EVP_EncryptInit_ex(ctx, nullptr, nullptr,
+                              reinterpret_cast<const uchar*>(keyBytes.constData()), nonce) == 1
+        && (aad.isEmpty() || EVP_EncryptUpdate(ctx, nullptr, &length,
+                                               reinterpret_cast<const uchar*>(aad.constData()),
+                                               int(aad.size())) == 1)
+        && EVP_EncryptUpdate(ctx, cipherText, &length,
+                             reinterpret_cast<const uchar*>(data.constData()), int(data.size())) == 1
+        && EVP_EncryptFinal_ex(ctx, cipherText + length, &length) == 1
+        && EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, AES_GCM_TAG_SIZE, tag) == 1;
+    EVP_CIPHER_CTX_free(ctx);
+
+    return ok ? sealed : QByteArray();
+}
+
+bool CryptoUtils::aesGcmDecrypt(const QByteArray& sealed, const QString& key, const QByteArray& aad,
+                                QByteArray& data) {
+    data.clear();
+    const qint64 size = sealed.size() - AES_GCM_NONCE_SIZE - AES_GCM_TAG_SIZE;
+    if (size < 0) {
+        return false;
+    }
+
+    const QByteArray keyBytes = aesKey(key);
+    const uchar* nonce = reinterpret_cast<const uchar*>(sealed.constData());
+    const uchar* cipherText = nonce + AES_GCM_NONCE_SIZE;
+    const uchar* tag = cipherText + size;
+
+    QByteArray plain(size, Qt::Uninitialized);
+    uchar* out = reinterpret_cast<uchar*>(plain.data());
+
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    int length = 0;
+    const bool ok = ctx
+        && EVP_DecryptInit_ex(ctx, EVP_aes_256_gcm(), nullptr, nullptr, nullptr) == 1
+        && EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, AES_GCM_NONCE_SIZE, nullptr) == 1
+        && EVP_DecryptInit_ex(ctx, nullptr, nullptr,
+                              reinterpret_cast<const uchar*>(keyBytes.constData()), nonce) == 1
+        && (aad.isEmpty() || EVP_DecryptUpdate(ctx, nullptr, &length,
+                                               reinterpret_cast<const uchar*>(aad.constData()),
+                                               int(aad.size())) == 1)
+        && EVP_DecryptUpdate(ctx, out, &length, cipherText, int(size)) == 1
+        && EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, AES_GCM_TAG_SIZE, const_cast<uchar*>(tag)) == 1
+        // Тег проверяется в DecryptFinal: до этого расшифрованным данным доверять нельзя
+        && EVP_DecryptFinal_ex(ctx, out + length, &length) == 1;
+    EVP_CIPHER_CTX_free(ctx);
+
+    if (ok) {
+        data = plain;
+    }
+    return ok;
 }
 
 QString CryptoUtils::hashPassword(const QString& password) {
-    QByteArray passwordBytes = password.toUtf8();
-    QByteArray hash = QCryptographicHash::hash(passwordBytes, QCryptographicHash::Sha256);
-    return hash.toHex();
-}
\ No newline at end of file
+    return hashPassword(password, passwordIterations());
+}
+
+QString CryptoUtils::hashPassword(const QString& password, int iterations) {
+    QByteArray salt(PBKDF2_SALT_SIZE, Qt::Uninitialized);
+    quint32 saltWords[PBKDF2_SALT_SIZE / sizeof(quint32)];
+    QRandomGenerator::system()->fillRange(saltWords);
+    std::memcpy(salt.data(), saltWords, PBKDF2_SALT_SIZE);
+
+    const QByteArray derived = pbkdf2(password.toUtf8(), salt, iterations);
+    if (derived.isEmpty()) {
+        qWarning() << "PBKDF2 failed";
+        return QString();
+    }
+    return QString("%1$%2$%3$%4")
+        .arg(PBKDF2_PREFIX)
+        .arg(iterations)
+        .arg(QString::fromLatin1(salt.toBase64()), QString::fromLatin1(derived.toBase64()));
+}
+
+bool CryptoUtils::verifyPassword(const QString& password, const QString& storedHash, bool* needsRehash) {
+    if (needsRehash) {
+        *needsRehash = false;
+    }
+
+    QByteArray expected;
+    QByteArray actual;
+    bool outdated = false;
+
+    const QStringList parts = storedHash.split('$');
+    if (parts.size() == 4 && parts[0] == PBKDF2_PREFIX) {
+        bool ok = false;
+        const int iterations = parts[1].toInt(&ok);
+        if (!ok || iterations < 1 || iterations > PBKDF2_MAX_ITERATIONS) {
+            return false;
+        }
+        expected = QByteArray::fromBase64(parts[3].toLatin1());
+        actual = pbkdf2(password.toUtf8(), QByteArray::fromBase64(parts[2].toLatin1()), iterations);
+        // Запас в два раза не даёт перехешировать пароли из-за разброса
+        // калибровки; хеши импорта с минимумом итераций усиливаются всегда
+        const int calibrated = passwordIterations();
+        outdated = iterations < calibrated / 2
+            || (iterations <= PBKDF2_MIN_ITERATIONS && calibrated > PBKDF2_MIN_ITERATIONS);
+    } else if (storedHash.size() == 64) {
+        // Хеши до перехода на PBKDF2: несолёный SHA-256 в hex
+        expected = QByteArray::fromHex(storedHash.toLatin1());
+        actual = QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha256);
+        outdated = true;
+    } else {
+        return false;
+    }
+
+    const bool valid = !actual.isEmpty() && actual.size() == expected.size()
+        && CRYPTO_memcmp(actual.constData(), expected.constData(), size_t(actual.size())) == 0;
+    if (valid && needsRehash) {
+        *needsRehash = outdated;
+    }
+    return valid;
+}
+
+QFuture<QString> CryptoUtils::hashPasswordAsync(const QString& password) {
+    return QtConcurrent::run([password]() { return hashPassword(password); });
+}
+
+QFuture<CryptoUtils::PasswordCheck> CryptoUtils::verifyPasswordAsync(const QString& password,
+                                                                   const QString& storedHash) {
+    return QtConcurrent::run([password, storedHash]() {
+        PasswordCheck check;
+        bool needsRehash = false;
+        if (storedHash.isEmpty()) {
+            verifyPassword(password, dummyPasswordHash());
+            return check;
+        }
+
+        check.valid = verifyPassword(password, storedHash, &needsRehash);
+        if (check.valid && needsRehash) {
+            check.upgradedHash = hashPassword(password);
+        }
+        return check;
+    });
+}
+
+int CryptoUtils::calibratePasswordIterations(int targetMs) {
+    // Пробный прогон на фиксированном числе итераций, затем линейная экстраполяция:
+    // стоимость PBKDF2 строго пропорциональна числу итераций
+    const int probeIterations = 20000;
+    const QByteArray salt(PBKDF2_SALT_SIZE, 'x');
+
+    QElapsedTimer timer;
+    timer.start();
+    pbkdf2("calibration", salt, probeIterations);
+    const qint64 elapsedNs = qMax<qint64>(timer.nsecsElapsed(), 1);
+
+    const double iterations = double(probeIterations) * targetMs * 1000000.0 / double(elapsedNs);
+    const int result = int(qBound(double(PBKDF2_MIN_ITERATIONS), iterations, double(PBKDF2_MAX_ITERATIONS)));
+    qInfo() << "PBKDF2 calibrated to" << result << "iterations for" << targetMs << "ms";
+    return result;
+}
+
+int CryptoUtils::passwordIterations() {
+    static const int iterations = calibratePasswordIterations();
+    return iterations;
+}
+
+XorKeyStream::XorKeyStream()
+    : m_keySize(0), m_offset(0), m_position(0), m_kernel(CryptoUtils::xorKernel()) {
+}
+
+XorKeyStream::XorKeyStream(const QString& key, qint64 position)
+    : XorKeyStream() {
+    const QByteArray keyBytes = key.toUtf8();
+    m_keySize = keyBytes.size();
+    if (m_keySize > 0) {
+        m_expanded.resize(m_keySize + EXPANDED_KEY_TAIL);
+        for (qint64 i = 0; i < m_expanded.size(); ++i) {
+            m_expanded[i] = keyBytes[i % m_keySize];
+        }
+    }
+    seek(position);
+}
+
+void XorKeyStream::apply(char* data, qint64 size) {
+    apply(data, data, size);
+}
+
+void XorKeyStream::apply(const char* src, char* dest, qint64 size) {
+    if (size <= 0) {
+        return;
+    }
+
+    if (m_keySize == 0) {
+        if (src != dest) {
+            std::memcpy(dest, src, size_t(size));
+        }
+    } else {
+        m_offset = runKernel(m_kernel, reinterpret_cast<const uchar*>(src), reinterpret_cast<uchar*>(dest), size,
+                             reinterpret_cast<const uchar*>(m_expanded.constData()), m_keySize, m_offset);
+    }
+    m_position += size;
+}
+
+void XorKeyStream::seek(qint64 position) {
+    m_position = position;
+    m_offset = m_keySize > 0 ? position % m_keySize : 0;
+}
+
+qint64 XorKeyStream::position() const {
+    return m_position;
+}
+
+bool XorKeyStream::isEmpty() const {
+    return m_keySize == 0;
+}
+
+void XorKeyStream::setKernel(CryptoUtils::XorKernel kernel) {
+    if (CryptoUtils::isXorKernelSupported(kernel)) {
+        m_kernel = kernel;
+    }
+}
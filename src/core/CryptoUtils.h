@@ -2,6 +2,7 @@
 #define CRYPTOUTILS_H
 
 #include <QByteArray>
+#include <QFuture>
 #include <QString>
 
 /**
@@ -12,6 +13,16 @@
 class CryptoUtils
 {
 public:
+    /**
+     * @brief Реализация XOR-преобразования.
+     * Выбирается один раз по возможностям процессора (см. xorKernel()).
+     */
+    enum class XorKernel {
+        Scalar,
+        Sse2,
+        Avx2
+    };
+
     /**
      * @brief Шифрует или дешифрует данные с помощью XOR алгоритма.
      * @param data Данные для шифрования/дешифрования
@@ -19,16 +30,177 @@ public:
      * @return Зашифрованные/расшифрованные данные
      */
     static QByteArray xorEncryptDecrypt(const QByteArray& data, const QString& key);
+
+    /**
+     * @brief Шифрует или дешифрует данные на месте, без копии.
+     * @param data Данные для шифрования/дешифрования
+     * @param key Ключ для шифрования
+     */
+    static void xorInPlace(QByteArray& data, const QString& key);
+
+    /**
+     * @brief Возвращает реализацию XOR, выбранную для текущего процессора.
+     */
+    static XorKernel xorKernel();
+
+    /**
+     * @brief Проверяет, поддерживает ли процессор реализацию XOR.
+     */
+    static bool isXorKernelSupported(XorKernel kernel);
+
+    /**
+     * @brief Возвращает имя реализации XOR для логов и бенчмарков.
+     */
+    static QString xorKernelName(XorKernel kernel);
+
+    // Размеры служебных полей AES-GCM в начале и в конце зашифрованного блока
+    static const int AES_GCM_NONCE_SIZE = 12;
+    static const int AES_GCM_TAG_SIZE = 16;
+
+    /**
+     * @brief Шифрует данные AES-256-GCM (OpenSSL, AES-NI при наличии).
+     * Ключ AES - SHA-256 от строки key. Для каждого вызова генерируется
+     * случайный nonce.
+     * @param data Открытые данные
+     * @param key Ключ шифрования
+     * @param aad Дополнительные данные, защищаемые тегом, но не шифруемые
+     * @return nonce || шифртекст || тег, пустой массив при ошибке
+     */
+    static QByteArray aesGcmEncrypt(const QByteArray& data, const QString& key, const QByteArray& aad);
+
+    /**
+     * @brief Расшифровывает и проверяет блок, созданный aesGcmEncrypt().
+     * @param sealed nonce || шифртекст || тег
+     * @param key Ключ шифрования
+     * @param aad Те же дополнительные данные, что и при шифровании
+     * @param data Расшифрованные данные
+     * @return false если тег не совпал (данные или ключ изменены)
+     */
+    static bool aesGcmDecrypt(const QByteArray& sealed, const QString& key, const QByteArray& aad,
+                              QByteArray& data);
     
+    /**
+     * @brief Результат проверки пароля.
+     */
+    struct PasswordCheck {
+        bool valid = false;
+        QString upgradedHash; // новый хеш, если сохранённый устарел, иначе пусто
+    };
+
+    // Границы числа итераций PBKDF2, подбираемого calibratePasswordIterations()
+    static const int PBKDF2_MIN_ITERATIONS = 100000;
+    static const int PBKDF2_MAX_ITERATIONS = 10000000;
+    // Целевое время одного хеширования пароля на этой машине
+    static const int PASSWORD_HASH_TARGET_MS = 250;
+
     /**
      * @brief Хеширует пароль для безопасного хранения.
+     * PBKDF2-HMAC-SHA256 со случайной солью и числом итераций
+     * passwordIterations(). Формат: pbkdf2-sha256$итерации$соль$хеш
+     * (соль и хеш в Base64). Выполняется сотни миллисекунд, поэтому из
+     * GUI следует вызывать hashPasswordAsync().
      * @param password Пароль для хеширования
      * @return Хешированный пароль в виде строки
      */
     static QString hashPassword(const QString& password);
 
+    /**
+     * @brief Хеширует пароль с заданным числом итераций PBKDF2.
+     */
+    static QString hashPassword(const QString& password, int iterations);
+
+    /**
+     * @brief Проверяет пароль по сохранённому хешу.
+     * Поддерживаются хеши PBKDF2 и прежние несолёные SHA-256 (64 hex-символа).
+     * @param password Введённый пароль
+     * @param storedHash Хеш из users.password_hash
+     * @param needsRehash true, если пароль верен, но хеш устарел (SHA-256,
+     * вдвое меньше итераций, чем подобрано для этой машины, или
+     * PBKDF2_MIN_ITERATIONS у хешей массового импорта)
+     * @return true если пароль верен
+     */
+    static bool verifyPassword(const QString& password, const QString& storedHash, bool* needsRehash = nullptr);
+
+    /**
+     * @brief Хеширует пароль в рабочем потоке.
+     */
+    static QFuture<QString> hashPasswordAsync(const QString& password);
+
+    /**
+     * @brief Проверяет пароль в рабочем потоке; устаревший хеш там же пересчитывается.
+     * Пустой storedHash (нет такого пользователя) проверяется так же долго,
+     * как настоящий, чтобы время ответа не выдавало существующие логины.
+     */
+    static QFuture<PasswordCheck> verifyPasswordAsync(const QString& password, const QString& storedHash);
+
+    /**
+     * @brief Подбирает число итераций PBKDF2 под целевое время на этой машине.
+     * @param targetMs Желаемое время одного хеширования
+     * @return Число итераций в пределах [PBKDF2_MIN_ITERATIONS, PBKDF2_MAX_ITERATIONS]
+     */
+    static int calibratePasswordIterations(int targetMs = PASSWORD_HASH_TARGET_MS);
+
+    /**
+     * @brief Число итераций для новых хешей.
+     * При первом вызове выполняется калибровка, результат запоминается.
+     */
+    static int passwordIterations();
+
 private:
     CryptoUtils() = delete;
 };
 
-#endif // CRYPTOUTILS_H
\ No newline at end of file
+/**
+ * @brief Потоковое XOR-преобразование с циклическим ключом.
+ * Ключ один раз разворачивается в повторяющийся блок, из которого ключевые
+ * байты читаются целыми векторами. Позиция в ключевом потоке сохраняется
+ * между вызовами, поэтому данные можно обрабатывать частями произвольного
+ * размера: результат совпадает с CryptoUtils::xorEncryptDecrypt для всего
+ * блока сразу. Пустой ключ означает копирование без изменений.
+ */
+class XorKeyStream
+{
+public:
+    XorKeyStream();
+
+    /**
+     * @brief Создаёт поток для ключа.
+     * @param key Ключ (используется в UTF-8)
+     * @param position Начальная позиция в ключевом потоке
+     */
+    explicit XorKeyStream(const QString& key, qint64 position = 0);
+
+    /**
+     * @brief Преобразует данные на месте и сдвигает позицию.
+     */
+    void apply(char* data, qint64 size);
+
+    /**
+     * @brief Преобразует данные из src в dest и сдвигает позицию.
+     * Области могут совпадать полностью, но не частично.
+     */
+    void apply(const char* src, char* dest, qint64 size);
+
+    /**
+     * @brief Переходит к позиции ключевого потока (например, к смещению в сегменте).
+     */
+    void seek(qint64 position);
+
+    qint64 position() const;
+    bool isEmpty() const;
+
+    /**
+     * @brief Принудительно задаёт реализацию (для бенчмарков).
+     * Неподдерживаемая процессором реализация игнорируется.
+     */
+    void setKernel(CryptoUtils::XorKernel kernel);
+
+private:
+    QByteArray m_expanded; // ключ, повторённый на длину ключа плюс запас под вектор
+    qint64 m_keySize;
+    qint64 m_offset;       // position % m_keySize
+    qint64 m_position;
+    CryptoUtils::XorKernel m_kernel;
+};
+
+#endif // CRYPTOUTILS_H
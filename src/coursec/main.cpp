@@ -0,0 +1,277 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+#include <QThreadPool>
+
+#include "core/AppSettings.h"
+#include "core/CourseBenchmark.h"
+#include "core/CourseFormat.h"
+#include "core/CourseManager.h"
+#include "core/CourseVerifier.h"
+#include "core/CourseView.h"
+
+/**
+ * @brief Консольный компилятор и инспектор файлов курса.
+ * Не требует GUI и подключения к БД, поэтому работает на сборочных машинах.
+ *
+ * coursec compile <course.json> <course.bin> [--codec none|zlib|lz4] [--cipher xor|aes-gcm] [--threads N]
+ * coursec dump <course.bin> [--content]
+ * coursec verify <course.bin> [--quick]
+ * coursec convert <in.bin> <out.bin> [--format v1|v2] [--codec none|zlib|lz4] [--cipher xor|aes-gcm]
+ * coursec bench load <course.bin> [--iterations N]
+ * coursec bench save|codecs|compile|ciphers [каталог] [--chapters N] [--iterations N]
+ * coursec bench xor [--iterations N]
+ */
+
+namespace {
+
+QTextStream& out() {
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+int usageError(const QCommandLineParser& parser, const QString& message) {
+    qCritical().noquote() << message;
+    qCritical().noquote() << parser.helpText();
+    return 2;
+}
+
+int runCompile(const QStringList& args, const QString& key, CourseFormat::Codec codec,
+               CourseFormat::Cipher cipher) {
+    if (!CourseManager::compileCourseFromJSON(args.at(0), args.at(1), key, codec, cipher)) {
+        qCritical().noquote() << "Failed to compile" << args.at(0);
+        return 1;
+    }
+    return 0;
+}
+
+int runDump(const QString& binPath, const QString& key, bool withContent) {
+    QFile file(binPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCritical().noquote() << "Cannot open" << binPath;
+        return 1;
+    }
+
+    const quint32 magic = CourseFormat::readMagic(binPath);
+    out() << "File: " << binPath << "\n";
+    out() << "Size: " << file.size() << " bytes\n";
+
+    if (magic == CourseFormat::MAGIC_NUMBER_V2) {
+        CourseFormat::Header header;
+        QList<CourseFormat::ChapterEntry> entries;
+        if (!CourseFormat::readHeader(&file, header) || !CourseFormat::readIndex(&file, header, entries)) {
+            qCritical().noquote() << "Invalid course header or index";
+            return 1;
+        }
+
+        out() << "Format: v2, revision " << header.revision << "\n";
+        out() << "Cipher: " << CourseFormat::cipherName(header.cipher) << "\n";
+        if (header.cipher == CourseFormat::Cipher::AesGcm) {
+            out() << "File ID: " << QString::number(header.fileId, 16).rightJustified(16, '0') << "\n";
+        }
+        out() << "Generation: " << header.generation << ", active slot " << header.activeSlot << "\n";
+        out() << "Index offset: " << header.indexOffset << "\n";
+        out() << "Chapters: " << entries.size() << "\n";
+        out() << "Index CRC32C: " << QString::number(header.indexChecksum, 16).rightJustified(8, '0') << "\n";
+        out() << "\n";
+
+        out() << QString("%1 | %2 | %3 | %4 | %5 | %6 | %7\n")
+                     .arg("#", -5)
+                     .arg("Offset", -10)
+                     .arg("Length", -8)
+                     .arg("Raw", -8)
+                     .arg("Codec", -5)
+                     .arg("CRC32C", -8)
+                     .arg("Title");
+
+        CourseView view;
+        const bool hasView = view.open(binPath, key);
+        for (int i = 0; i < entries.size(); ++i) {
+            const CourseFormat::ChapterEntry& entry = entries[i];
+            out() << QString("%1 | %2 | %3 | %4 | %5 | %6 | %7\n")
+                         .arg(i, -5)
+                         .arg(entry.offset, -10)
+                         .arg(entry.length, -8)
+                         .arg(entry.rawLength, -8)
+                         .arg(CourseFormat::codecName(entry.codec), -5)
+                         .arg(QString::number(entry.checksum, 16).rightJustified(8, '0'), -8)
+                         .arg(hasView ? view.chapterTitle(i) : QString("?"));
+        }
+    } else if (magic == CourseFormat::MAGIC_NUMBER_V1) {
+        out() << "Format: v1 (single encrypted block)\n";
+    } else {
+        qCritical().noquote() << "Unknown file format, magic" << QString::number(magic, 16);
+        return 1;
+    }
+
+    if (!withContent) {
+        return 0;
+    }
+
+    const Course course = CourseManager::loadCourseFromBinary(binPath, key);
+    for (const Chapter& chapter : course.chapters) {
+        out() << "\n=== " << chapter.id << ". " << chapter.title << " ===\n";
+        out() << chapter.content << "\n";
+        for (const Question& question : chapter.questions) {
+            out() << "Q: " << question.q_text << "\n";
+            for (int i = 0; i < question.options.size(); ++i) {
+                out() << (i == question.correct_index ? "  * " : "  - ") << question.options[i] << "\n";
+            }
+        }
+    }
+    return course.chapters.isEmpty() ? 1 : 0;
+}
+
+int runVerify(const QString& binPath, const QString& key, bool quick) {
+    if (quick) {
+        QString errorString;
+        if (!CourseVerifier::quickCheck(binPath, nullptr, &errorString)) {
+            qCritical().noquote() << errorString;
+            return 1;
+        }
+        out() << "Header and chapter index are valid\n";
+        return 0;
+    }
+
+    const CourseVerifier::Report report = CourseVerifier::deepVerify(binPath, key);
+    out() << "Revision: " << report.revision << ", chapters: " << report.chapterCount
+          << ", checked " << report.bytesChecked << " bytes in " << report.elapsedMs << " ms\n";
+    if (!report.isValid()) {
+        qCritical().noquote() << report.errorString;
+        for (int chapterIndex : report.corruptedChapters) {
+            out() << "Corrupted chapter: " << chapterIndex << "\n";
+        }
+        return 1;
+    }
+    out() << "Course file is valid\n";
+    return 0;
+}
+
+int runConvert(const QStringList& args, const QString& key, const QString& format, CourseFormat::Codec codec,
+               CourseFormat::Cipher cipher) {
+    const Course course = CourseManager::loadCourseFromBinary(args.at(0), key);
+    if (course.chapters.isEmpty()) {
+        qCritical().noquote() << "Cannot load course from" << args.at(0);
+        return 1;
+    }
+
+    const bool saved = (format == "v1")
+        ? CourseManager::saveCourseToLegacyBinary(course, args.at(1), key)
+        : CourseManager::saveCourseToBinary(course, args.at(1), key, codec, cipher);
+    if (!saved) {
+        qCritical().noquote() << "Cannot write" << args.at(1);
+        return 1;
+    }
+    out() << "Converted " << course.chapters.size() << " chapters to " << format << ": " << args.at(1) << "\n";
+    return 0;
+}
+
+int runBench(const QStringList& args, const QString& key, int chapters, int iterations) {
+    const QString kind = args.value(0);
+    const QString target = args.value(1);
+
+    if (kind == "load") {
+        if (target.isEmpty()) {
+            return -1;
+        }
+        CourseBenchmark::compareLoadPaths(target, key, iterations > 0 ? iterations : 20);
+        return 0;
+    }
+
+    if (kind == "xor") {
+        CourseBenchmark::compareXorKernels(key, 64, iterations > 0 ? iterations : 10);
+        return 0;
+    }
+
+    const QString workDir = target.isEmpty() ? QDir::tempPath() : target;
+    if (kind == "save") {
+        CourseBenchmark::compareSavePaths(workDir, key, chapters > 0 ? chapters : 1000,
+                                          iterations > 0 ? iterations : 20);
+    } else if (kind == "codecs") {
+        CourseBenchmark::compareCodecs(workDir, key);
+    } else if (kind == "compile") {
+        CourseBenchmark::compareCompileThreads(workDir, key, chapters > 0 ? chapters : 5000);
+    } else if (kind == "ciphers") {
+        CourseBenchmark::compareCiphers(workDir, key, chapters > 0 ? chapters : 2000,
+                                        iterations > 0 ? iterations : 5);
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("coursec");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Course compiler and inspector");
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", "compile | dump | verify | convert | bench");
+    parser.addPositionalArgument("args", "Command arguments", "[args...]");
+
+    const QCommandLineOption keyOption("key", "Encryption key.", "key", AppSettings::ENCRYPTION_KEY);
+    const QCommandLineOption codecOption("codec", "Chapter codec: none, zlib, lz4.", "codec",
+                                         CourseFormat::codecName(CourseFormat::DEFAULT_CODEC));
+    const QCommandLineOption cipherOption("cipher", "Course file cipher: xor, aes-gcm.", "cipher",
+                                          CourseFormat::cipherName(CourseFormat::Cipher::Xor));
+    const QCommandLineOption formatOption("format", "Target format for convert: v1, v2.", "format", "v2");
+    const QCommandLineOption threadsOption("threads", "Worker threads for compile.", "count");
+    const QCommandLineOption chaptersOption("chapters", "Chapters in synthetic benchmark courses.", "count");
+    const QCommandLineOption iterationsOption("iterations", "Benchmark iterations.", "count");
+    const QCommandLineOption quickOption("quick", "Verify header and chapter index only.");
+    const QCommandLineOption contentOption("content", "Dump chapter content and questions.");
+    parser.addOptions({keyOption, codecOption, cipherOption, formatOption, threadsOption, chaptersOption,
+                       iterationsOption, quickOption, contentOption});
+    parser.process(app);
+
+    QStringList args = parser.positionalArguments();
+    if (args.isEmpty()) {
+        return usageError(parser, "Command is required");
+    }
+    const QString command = args.takeFirst();
+    const QString key = parser.value(keyOption);
+
+    CourseFormat::Codec codec = CourseFormat::DEFAULT_CODEC;
+    if (!CourseFormat::codecFromName(parser.value(codecOption), codec)) {
+        return usageError(parser, QString("Unknown codec: %1").arg(parser.value(codecOption)));
+    }
+    CourseFormat::Cipher cipher = CourseFormat::Cipher::Xor;
+    if (!CourseFormat::cipherFromName(parser.value(cipherOption), cipher)) {
+        return usageError(parser, QString("Unknown cipher: %1").arg(parser.value(cipherOption)));
+    }
+    if (parser.isSet(threadsOption)) {
+        QThreadPool::globalInstance()->setMaxThreadCount(qMax(1, parser.value(threadsOption).toInt()));
+    }
+
+    if (command == "compile" && args.size() == 2) {
+        return runCompile(args, key, codec, cipher);
+    }
+    if (command == "dump" && args.size() == 1) {
+        return runDump(args.at(0), key, parser.isSet(contentOption));
+    }
+    if (command == "verify" && args.size() == 1) {
+        return runVerify(args.at(0), key, parser.isSet(quickOption));
+    }
+    if (command == "convert" && args.size() == 2) {
+        const QString format = parser.value(formatOption);
+        if (format != "v1" && format != "v2") {
+            return usageError(parser, QString("Unknown format: %1").arg(format));
+        }
+        return runConvert(args, key, format, codec, cipher);
+    }
+    if (command == "bench" && !args.isEmpty() && args.size() <= 2) {
+        const int result = runBench(args, key, parser.value(chaptersOption).toInt(),
+                                    parser.value(iterationsOption).toInt());
+        if (result >= 0) {
+            return result;
+        }
+    }
+
+    return usageError(parser, QString("Invalid arguments for command: %1").arg(command));
+}
@@ -0,0 +1,138 @@
+#include "db/AsyncDatabase.h"
+#include <QDebug>
+#include <QFutureWatcher>
+#include <QThread>
+#include <QTimer>
+#include <libpq-fe.h>
+
+QueryControl::~QueryControl() {
+    detach();
+}
+
+void QueryControl::cancel(bool timedOut) {
+    QMutexLocker locker(&m_mutex);
+    if (m_cancelled) {
+        return;
+    }
+    m_cancelled = true;
+    // После detach() запрос уже завершён: таймаут на его результат не влияет
+    m_timedOut = timedOut && !m_detached;
+
+    if (m_cancel) {
+        char error[256];
+        if (!PQcancel(m_cancel, error, sizeof(error))) {
+            qWarning() << "Failed to cancel query:" << error;
+        }
+    }
+}
+
+bool QueryControl::isCancelled() const {
+    QMutexLocker locker(&m_mutex);
+    return m_cancelled;
+}
+
+bool QueryControl::isTimedOut() const {
+    QMutexLocker locker(&m_mutex);
+    return m_timedOut;
+}
+
+bool QueryControl::attach(PGconn* connection) {
+    QMutexLocker locker(&m_mutex);
+    if (m_cancelled) {
+        return false;
+    }
+    if (connection) {
+        m_cancel = PQgetCancel(connection);
+    }
+    return true;
+}
+
+void QueryControl::detach() {
+    QMutexLocker locker(&m_mutex);
+    m_detached = true;
+    if (m_cancel) {
+        PQfreeCancel(m_cancel);
+        m_cancel = nullptr;
+    }
+}
+
+AsyncDatabase::AsyncDatabase(QObject* parent)
+    : QObject(parent) {
+    // Менеджер (и пул) создаются раньше, чтобы пережить поток БД
+    DatabaseManager::getInstance();
+
+    // Один постоянный поток: его соединение не закрывается между запросами
+    m_pool.setMaxThreadCount(1);
+    m_pool.setExpiryTimeout(-1);
+    m_bulkPool.setMaxThreadCount(1);
+}
+
+AsyncDatabase::~AsyncDatabase() {
+    shutdown();
+}
+
+AsyncDatabase& AsyncDatabase::getInstance() {
+    static AsyncDatabase instance;
+    return instance;
+}
+
+void AsyncDatabase::shutdown() {
+    m_bulkPool.waitForDone();
+    m_pool.waitForDone();
+}
+
+void AsyncDatabase::watch(const QFuture<void>& future, const QSharedPointer<QueryControl>& control, int timeoutMs) {
+    Q_ASSERT(QThread::currentThread() == thread());
+
+    QFutureWatcher<void>* watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcherBase::canceled, this, [control]() { control->cancel(); });
+    connect(watcher, &QFutureWatcherBase::finished, watcher, &QObject::deleteLater);
+    if (timeoutMs > 0) {
+        // Таймер принадлежит наблюдателю и удаляется вместе с ним
+        QTimer::singleShot(timeoutMs, watcher, [control, timeoutMs]() {
+            qWarning() << "Database query exceeded" << timeoutMs << "ms, cancelling";
+            control->cancel(true);
+        });
+    }
+    watcher->setFuture(future);
+}
+
+QFuture<QueryResult<DatabaseManager::UserCredentials>> AsyncDatabase::getUserCredentials(const QString& login,
+                                                                                         int timeoutMs) {
+    return run<DatabaseManager::UserCredentials>([login](DatabaseManager::UserCredentials& credentials) {
+        return DatabaseManager::getInstance().getUserCredentials(login, credentials);
+    }, timeoutMs);
+}
+
+QFuture<QueryResult<bool>> AsyncDatabase::updatePasswordHash(int userId, const QString& passwordHash, int timeoutMs) {
+    return run<bool>([userId, passwordHash](bool& updated) {
+        updated = DatabaseManager::getInstance().updatePasswordHash(userId, passwordHash);
+        return updated;
+    }, timeoutMs);
+}
+
+QFuture<QueryResult<bool>> AsyncDatabase::registerUser(const QString& login, const QString& passwordHash,
+                                                       const QString& role, int timeoutMs) {
+    return run<bool>([login, passwordHash, role](bool& registered) {
+        registered = DatabaseManager::getInstance().registerUser(login, passwordHash, role);
+        return registered;
+    }, timeoutMs);
+}
+
+QFuture<QueryResult<QList<DatabaseManager::ProgressRecord>>> AsyncDatabase::getUserProgress(int userId, int timeoutMs) {
+    return run<QList<DatabaseManager::ProgressRecord>>([userId](QList<DatabaseManager::ProgressRecord>& records) {
+        return DatabaseManager::getInstance().getUserProgress(userId, records);
+    }, timeoutMs);
+}
+
+QFuture<UserImportReport> AsyncDatabase::importUsers(const QList<UserImportRow>& rows, UserImportReport report) {
+    return QtConcurrent::run(&m_bulkPool, [rows, report](QPromise<UserImportReport>& promise) mutable {
+        promise.setProgressRange(0, int(rows.size()));
+        DatabaseManager::getInstance().importUsers(rows, report, [&promise](int done, int total) {
+            promise.setProgressRange(0, total);
+            promise.setProgressValue(done);
+            return !promise.isCanceled();
+        });
+        promise.addResult(report);
+    });
+}
@@ -0,0 +1,192 @@
+#ifndef ASYNCDATABASE_H
+#define ASYNCDATABASE_H
+
+#include <QFuture>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+#include <QPromise>
+#include <QSharedPointer>
+#include <QString>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <functional>
+#include "db/ConnectionPool.h"
+#include "db/DatabaseManager.h"
+
+typedef struct pg_cancel PGcancel;
+
+/**
+ * @brief Результат асинхронного запроса.
+ */
+template<typename T>
+struct QueryResult {
+    bool ok = false;
+    bool timedOut = false;  // запрос прерван по истечении таймаута
+    T value{};
+    QString errorString;
+};
+
+/**
+ * @brief Управление одним асинхронным запросом: отмена через PQcancel.
+ * Отмена безопасна из любого потока; если запрос ещё в очереди,
+ * он не будет выполнен.
+ */
+class QueryControl
+{
+public:
+    QueryControl() = default;
+    ~QueryControl();
+
+    /**
+     * @brief Прерывает запрос.
+     * @param timedOut true если причина - истечение таймаута
+     */
+    void cancel(bool timedOut = false);
+
+    bool isCancelled() const;
+
+    /**
+     * @brief Был ли запрос прерван таймаутом до завершения (до detach()).
+     */
+    bool isTimedOut() const;
+
+    /**
+     * @brief Связывает запрос с соединением, на котором он выполняется.
+     * Вызывается в потоке БД перед запросом.
+     * @return false если запрос уже отменён и выполнять его не нужно
+     */
+    bool attach(PGconn* connection);
+
+    /**
+     * @brief Отвязывает запрос от соединения после выполнения.
+     */
+    void detach();
+
+    QueryControl(const QueryControl&) = delete;
+    QueryControl& operator=(const QueryControl&) = delete;
+
+private:
+    mutable QMutex m_mutex;
+    PGcancel* m_cancel = nullptr;
+    bool m_cancelled = false;
+    bool m_timedOut = false;
+    bool m_detached = false;
+};
+
+/**
+ * @brief Неблокирующий доступ к базе данных.
+ *
+ * Запросы выполняются в выделенном потоке БД (QThreadPool из одного
+ * потока со своим соединением из ConnectionPool), результат возвращается
+ * как QFuture<QueryResult<T>>. Методы вызываются из основного потока.
+ *
+ * - Отмена: QFuture::cancel() отправляет серверу PQcancel для
+ *   выполняющегося запроса или снимает его с очереди.
+ * - Таймаут: если запрос не завершился за timeoutMs с момента постановки
+ *   в очередь, он прерывается через PQcancel, а результат помечается
+ *   timedOut. Значение 0 отключает таймаут.
+ *
+ * Внутри потока БД используются синхронные методы DatabaseManager:
+ * они арендуют то же соединение потока, поэтому PQcancel прерывает
+ * именно их запрос.
+ */
+class AsyncDatabase : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Получает единственный экземпляр класса (Singleton).
+     */
+    static AsyncDatabase& getInstance();
+
+    /**
+     * @brief Выполняет произвольную работу с БД в потоке БД.
+     * @param job Функция, заполняющая значение; при возврате false текст
+     * ошибки берётся из DatabaseManager::getLastError() потока БД
+     * @param timeoutMs Таймаут в миллисекундах
+     */
+    template<typename T>
+    QFuture<QueryResult<T>> run(const std::function<bool(T&)>& job, int timeoutMs = DEFAULT_TIMEOUT_MS);
+
+    QFuture<QueryResult<DatabaseManager::UserCredentials>> getUserCredentials(const QString& login,
+                                                                              int timeoutMs = DEFAULT_TIMEOUT_MS);
+    QFuture<QueryResult<bool>> updatePasswordHash(int userId, const QString& passwordHash,
+                                                  int timeoutMs = DEFAULT_TIMEOUT_MS);
+    QFuture<QueryResult<bool>> registerUser(const QString& login, const QString& passwordHash,
+                                            const QString& role = "student", int timeoutMs = DEFAULT_TIMEOUT_MS);
+    QFuture<QueryResult<QList<DatabaseManager::ProgressRecord>>> getUserProgress(int userId,
+                                                                                 int timeoutMs = DEFAULT_TIMEOUT_MS);
+
+    /**
+     * @brief Массовый импорт пользователей (DatabaseManager::importUsers).
+     * Импорт долгий, поэтому выполняется не в потоке БД, а в отдельном
+     * потоке со своим соединением и не задерживает остальные запросы.
+     * Прогресс - число обработанных строк; QFuture::cancel() прерывает
+     * импорт после текущего пакета с откатом транзакции, отменённый
+     * QFuture не содержит результата.
+     */
+    QFuture<UserImportReport> importUsers(const QList<UserImportRow>& rows, UserImportReport report);
+
+    /**
+     * @brief Дожидается выполнения всех поставленных запросов.
+     * Вызывается при завершении работы приложения, чтобы не потерять
+     * сохранение прогресса.
+     */
+    void shutdown();
+
+    static const int DEFAULT_TIMEOUT_MS = 15000;
+
+    AsyncDatabase(const AsyncDatabase&) = delete;
+    AsyncDatabase& operator=(const AsyncDatabase&) = delete;
+
+private:
+    explicit AsyncDatabase(QObject* parent = nullptr);
+    ~AsyncDatabase();
+
+    /**
+     * @brief Связывает отмену QFuture и таймаут с QueryControl запроса.
+     */
+    void watch(const QFuture<void>& future, const QSharedPointer<QueryControl>& control, int timeoutMs);
+
+    QThreadPool m_pool;
+    QThreadPool m_bulkPool; // долгие массовые операции (импорт)
+};
+
+template<typename T>
+QFuture<QueryResult<T>> AsyncDatabase::run(const std::function<bool(T&)>& job, int timeoutMs) {
+    QSharedPointer<QueryControl> control(new QueryControl);
+    QFuture<QueryResult<T>> future = QtConcurrent::run(&m_pool, [job, control, timeoutMs](QPromise<QueryResult<T>>& promise) {
+        if (promise.isCanceled()) {
+            return;
+        }
+
+        QueryResult<T> result;
+        // Поток БД постоянный: соединение и его кэш запросов сохраняются
+        ConnectionPool::getInstance().keepCurrentThreadConnection();
+        ConnectionPool::Lease lease;
+        if (!lease.isValid()) {
+            result.errorString = lease.errorString();
+        } else if (control->attach(ConnectionPool::nativeHandle(lease.database()))) {
+            result.ok = job(result.value);
+            control->detach();
+            if (!result.ok) {
+                result.errorString = DatabaseManager::getInstance().getLastError();
+            }
+        }
+
+        // Успешно завершённая работа (например, зафиксированная запись)
+        // не считается прерванной, даже если таймер сработал сразу после неё
+        if (!result.ok && control->isTimedOut()) {
+            result.timedOut = true;
+            result.errorString = QString("Query timed out after %1 ms").arg(timeoutMs);
+        }
+        promise.addResult(result);
+    });
+    watch(QFuture<void>(future), control, timeoutMs);
+    return future;
+}
+
+#endif // ASYNCDATABASE_H
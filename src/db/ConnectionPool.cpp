@@ -0,0 +1,333 @@
+#include "db/ConnectionPool.h"
+#include <QDeadlineTimer>
+#include <QDebug>
+#include <QSqlDriver>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+#include <libpq-fe.h>
+
+ConnectionPool::Lease::Lease()
+    : m_database(ConnectionPool::getInstance().acquire(&m_errorString)) {
+}
+
+ConnectionPool::Lease::~Lease() {
+    if (m_database.isValid()) {
+        m_database = QSqlDatabase();
+        ConnectionPool::getInstance().release();
+    }
+}
+
+bool ConnectionPool::Lease::isValid() const {
+    return m_database.isValid() && m_database.isOpen();
+}
+
+QSqlDatabase ConnectionPool::Lease::database() const {
+    return m_database;
+}
+
+QString ConnectionPool::Lease::errorString() const {
+    return m_errorString;
+}
+
+QSqlQuery* ConnectionPool::Lease::prepare(const QString& sql) {
+    if (!isValid()) {
+        return nullptr;
+    }
+    return ConnectionPool::getInstance().preparedQuery(sql, &m_errorString);
+}
+
+ConnectionPool::ThreadConnection::~ThreadConnection() {
+    if (open) {
+        ConnectionPool::getInstance().closeConnection(this);
+    }
+}
+
+ConnectionPool::ConnectionPool()
+    : m_maxSize(DEFAULT_MAX_SIZE), m_size(0), m_idle(0), m_idleWorkers(0), m_waiters(0), m_nextId(0)
+    , m_statementHits(0), m_statementMisses(0) {
+}
+
+ConnectionPool& ConnectionPool::getInstance() {
+    static ConnectionPool instance;
+    return instance;
+}
+
+void ConnectionPool::setOptions(const Options& options) {
+    QMutexLocker locker(&m_mutex);
+    m_options = options;
+}
+
+void ConnectionPool::setMaxSize(int maxSize) {
+    QMutexLocker locker(&m_mutex);
+    m_maxSize = qMax(1, maxSize);
+    m_slotFreed.wakeAll();
+}
+
+int ConnectionPool::maxSize() const {
+    QMutexLocker locker(&m_mutex);
+    return m_maxSize;
+}
+
+int ConnectionPool::size() const {
+    QMutexLocker locker(&m_mutex);
+    return m_size;
+}
+
+int ConnectionPool::idleCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_idle;
+}
+
+PGconn* ConnectionPool::nativeHandle(const QSqlDatabase& database) {
+    if (!database.isValid()) {
+        return nullptr;
+    }
+    const QVariant handle = database.driver()->handle();
+    if (handle.isValid() && qstrcmp(handle.typeName(), "PGconn*") == 0) {
+        return *static_cast<PGconn* const*>(handle.constData());
+    }
+    return nullptr;
+}
+
+quint64 ConnectionPool::statementCacheHits() const {
+    return m_statementHits.loadRelaxed();
+}
+
+quint64 ConnectionPool::statementCacheMisses() const {
+    return m_statementMisses.loadRelaxed();
+}
+
+ConnectionPool::ThreadConnection* ConnectionPool::currentConnection() {
+    ThreadConnection* connection = m_connections.localData();
+    if (!connection) {
+        connection = new ThreadConnection;
+        {
+            QMutexLocker locker(&m_mutex);
+            connection->name = QString("course_db_%1").arg(++m_nextId);
+        }
+        m_connections.setLocalData(connection);
+    }
+    return connection;
+}
+
+void ConnectionPool::keepCurrentThreadConnection() {
+    ThreadConnection* connection = currentConnection();
+    QMutexLocker locker(&m_mutex);
+    if (connection->idle && !connection->keep) {
+        --m_idleWorkers;
+    }
+    connection->keep = true;
+}
+
+QSqlDatabase ConnectionPool::acquire(QString* errorString) {
+    ThreadConnection* connection = currentConnection();
+
+    if (connection->open) {
+        if (connection->idle) {
+            QMutexLocker locker(&m_mutex);
+            connection->idle = false;
+            --m_idle;
+            if (!connection->keep) {
+                --m_idleWorkers;
+            }
+        }
+        ++connection->leases;
+
+        if (!isHealthy(connection)) {
+            qWarning() << "Database connection" << connection->name << "is broken, reconnecting";
+            // Подготовленные запросы принадлежат серверному сеансу и после переподключения не существуют
+            clearStatements(connection);
+            QSqlDatabase database = QSqlDatabase::database(connection->name, false);
+            database.close();
+            if (!database.open()) {
+                if (errorString) {
+                    *errorString = QString("Failed to reconnect to database: %1").arg(database.lastError().text());
+                }
+                --connection->leases;
+                return QSqlDatabase();
+            }
+        }
+        connection->lastUsed.restart();
+        return QSqlDatabase::database(connection->name, false);
+    }
+
+    // У потока нет соединения: ждём свободного места в пуле
+    {
+        QMutexLocker locker(&m_mutex);
+        QDeadlineTimer deadline(ACQUIRE_TIMEOUT_MS);
+        ++m_waiters;
+        while (m_size >= m_maxSize) {
+            if (!m_slotFreed.wait(&m_mutex, deadline)) {
+                --m_waiters;
+                if (errorString) {
+                    *errorString = QString("Connection pool exhausted: %1 connections in use").arg(m_size);
+                }
+                qWarning() << "Connection pool exhausted, max size" << m_maxSize;
+                return QSqlDatabase();
+            }
+        }
+        --m_waiters;
+        ++m_size;
+    }
+
+    if (!openConnection(connection, errorString)) {
+        QMutexLocker locker(&m_mutex);
+        --m_size;
+        m_slotFreed.wakeOne();
+        return QSqlDatabase();
+    }
+
+    connection->leases = 1;
+    connection->lastUsed.start();
+    return QSqlDatabase::database(connection->name, false);
+}
+
+void ConnectionPool::release() {
+    ThreadConnection* connection = m_connections.localData();
+    if (!connection || connection->leases == 0) {
+        return;
+    }
+    if (--connection->leases > 0 || !connection->open) {
+        return;
+    }
+
+    connection->lastUsed.restart();
+    bool closeNow = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        // Простаивающее соединение рабочего потока закроется при завершении
+        // потока; до тех пор оно не должно отнимать место у ожидающих
+        closeNow = m_waiters > 0 || (!connection->keep && m_idleWorkers >= MAX_IDLE_CONNECTIONS);
+        if (!closeNow) {
+            connection->idle = true;
+            ++m_idle;
+            if (!connection->keep) {
+                ++m_idleWorkers;
+            }
+        }
+    }
+    if (closeNow) {
+        closeConnection(connection);
+    }
+}
+
+void ConnectionPool::closeCurrentThread() {
+    if (ThreadConnection* connection = m_connections.localData()) {
+        connection->leases = 0;
+        closeConnection(connection);
+    }
+}
+
+bool ConnectionPool::openConnection(ThreadConnection* connection, QString* errorString) {
+    Options options;
+    {
+        QMutexLocker locker(&m_mutex);
+        options = m_options;
+    }
+
+    QSqlDatabase database = QSqlDatabase::contains(connection->name)
+        ? QSqlDatabase::database(connection->name, false)
+        : QSqlDatabase::addDatabase("QPSQL", connection->name);
+    database.setHostName(options.hostName);
+    database.setPort(options.port);
+    database.setDatabaseName(options.databaseName);
+    database.setUserName(options.userName);
+    database.setPassword(options.password);
+
+    if (!database.open()) {
+        const QString error = QString("Failed to connect to database: %1").arg(database.lastError().text());
+        qDebug() << error;
+        if (errorString) {
+            *errorString = error;
+        }
+        return false;
+    }
+
+    connection->open = true;
+    connection->idle = false;
+    qDebug() << "Database connection" << connection->name << "opened," << size() << "in pool";
+    return true;
+}
+
+bool ConnectionPool::isHealthy(ThreadConnection* connection) {
+    QSqlDatabase database = QSqlDatabase::database(connection->name, false);
+    PGconn* handle = nativeHandle(database);
+    if (!database.isOpen() || !handle || PQstatus(handle) != CONNECTION_OK) {
+        return false;
+    }
+
+    // Разрыв соединения libpq замечает только при обмене с сервером,
+    // поэтому давно не использованное соединение проверяется запросом
+    if (connection->lastUsed.isValid() && connection->lastUsed.elapsed() < HEALTH_CHECK_INTERVAL_MS) {
+        return true;
+    }
+    QSqlQuery query(database);
+    return query.exec("SELECT 1");
+}
+
+void ConnectionPool::closeConnection(ThreadConnection* connection) {
+    if (!connection->open) {
+        return;
+    }
+
+    // Запросы держат копию соединения и должны быть удалены до removeDatabase
+    clearStatements(connection);
+    {
+        QSqlDatabase database = QSqlDatabase::database(connection->name, false);
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(connection->name);
+    connection->open = false;
+
+    QMutexLocker locker(&m_mutex);
+    if (connection->idle) {
+        connection->idle = false;
+        --m_idle;
+        if (!connection->keep) {
+            --m_idleWorkers;
+        }
+    }
+    --m_size;
+    m_slotFreed.wakeOne();
+    qDebug() << "Database connection" << connection->name << "closed," << m_size << "in pool;"
+             << "statement cache hits:" << statementCacheHits() << "misses:" << statementCacheMisses();
+}
+
+QSqlQuery* ConnectionPool::preparedQuery(const QString& sql, QString* errorString) {
+    ThreadConnection* connection = m_connections.localData();
+    if (!connection || !connection->open) {
+        if (errorString) {
+            *errorString = "No database connection leased in this thread";
+        }
+        return nullptr;
+    }
+
+    if (QSqlQuery* query = connection->statements.value(sql)) {
+        m_statementHits.fetchAndAddRelaxed(1);
+        return query;
+    }
+
+    m_statementMisses.fetchAndAddRelaxed(1);
+    if (connection->statements.size() >= MAX_CACHED_STATEMENTS) {
+        qDebug() << "Prepared statement cache of" << connection->name << "is full, clearing";
+        clearStatements(connection);
+    }
+
+    QSqlQuery* query = new QSqlQuery(QSqlDatabase::database(connection->name, false));
+    if (!query->prepare(sql)) {
+        if (errorString) {
+            *errorString = QString("Failed to prepare statement: %1").arg(query->lastError().text());
+        }
+        delete query;
+        return nullptr;
+    }
+
+    connection->statements.insert(sql, query);
+    return query;
+}
+
+void ConnectionPool::clearStatements(ThreadConnection* connection) {
+    qDeleteAll(connection->statements);
+    connection->statements.clear();
+}
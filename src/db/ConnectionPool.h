@@ -0,0 +1,210 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QString>
+#include <QThreadStorage>
+#include <QWaitCondition>
+
+class QSqlQuery;
+typedef struct pg_conn PGconn;
+
+/**
+ * @brief Пул соединений PostgreSQL с привязкой к потокам.
+ *
+ * Соединение Qt SQL можно использовать только в потоке, который его создал,
+ * поэтому пул выдаёт каждому потоку собственное именованное соединение
+ * (course_db_<N>) и переиспользует его для всех аренд этого потока.
+ * Общее число открытых соединений ограничено maxSize(): поток без
+ * соединения ждёт освобождения места не дольше ACQUIRE_TIMEOUT_MS.
+ *
+ * - Проверка работоспособности: при аренде соединение со статусом
+ *   CONNECTION_BAD или простаивавшее дольше HEALTH_CHECK_INTERVAL_MS
+ *   проверяется запросом SELECT 1 и при необходимости переоткрывается.
+ * - Сокращение простаивающих: после последней аренды соединение остаётся
+ *   открытым вместе с кэшем подготовленных запросов, чтобы следующая
+ *   задача того же рабочего потока не переподключалась. Закрыть
+ *   соединение может только его поток, поэтому простаивающее соединение
+ *   рабочего потока закрывается при завершении потока (QThreadPool
+ *   завершает простаивающие потоки через expiryTimeout(), по умолчанию
+ *   30 с) деструктором ThreadConnection. Чтобы ожидающие потоки не
+ *   оставались без места, при освобождении соединение всё же закрывается,
+ *   если его место ждёт другой поток или простаивают уже
+ *   MAX_IDLE_CONNECTIONS соединений рабочих потоков. Соединение потока,
+ *   отмеченного keepCurrentThreadConnection() (поток БД AsyncDatabase),
+ *   в этот лимит не входит.
+ * - Кэш подготовленных запросов: у каждого соединения свой набор
+ *   именованных серверных prepared statements (QPSQL готовит их через
+ *   PREPARE), ключ - текст SQL. Повторный запрос пропускает разбор и
+ *   планирование на сервере. Кэш сбрасывается при переподключении.
+ *
+ * Основной способ работы - RAII-аренда Lease на время запроса.
+ */
+class ConnectionPool
+{
+public:
+    /**
+     * @brief Параметры подключения для всех соединений пула.
+     */
+    struct Options {
+        QString hostName;
+        int port = 5432;
+        QString databaseName;
+        QString userName;
+        QString password;
+    };
+
+    /**
+     * @brief Аренда соединения текущего потока.
+     * Пока жива хотя бы одна аренда, соединение потока не закрывается.
+     */
+    class Lease
+    {
+    public:
+        Lease();
+        ~Lease();
+
+        bool isValid() const;
+        QSqlDatabase database() const;
+        QString errorString() const;
+
+        /**
+         * @brief Возвращает подготовленный запрос из кэша соединения.
+         * Запрос готовится на сервере один раз; параметры задаются через
+         * bindValue(позиция, значение), после чтения результата следует
+         * вызвать finish(). Указатель действителен, пока жива аренда.
+         * @param sql Текст запроса с параметрами ?
+         * @return Запрос или nullptr (описание в errorString())
+         */
+        QSqlQuery* prepare(const QString& sql);
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+    private:
+        QSqlDatabase m_database;
+        QString m_errorString;
+    };
+
+    /**
+     * @brief Получает единственный экземпляр пула.
+     */
+    static ConnectionPool& getInstance();
+
+    /**
+     * @brief Задаёт параметры подключения. Вызывается до первой аренды.
+     */
+    void setOptions(const Options& options);
+
+    void setMaxSize(int maxSize);
+    int maxSize() const;
+
+    /**
+     * @brief Количество открытых соединений во всех потоках.
+     */
+    int size() const;
+
+    /**
+     * @brief Количество открытых соединений без активных аренд.
+     */
+    int idleCount() const;
+
+    /**
+     * @brief Выдаёт соединение текущего потока, при необходимости открывая его.
+     * Каждому успешному вызову должен соответствовать release() в том же потоке.
+     * @param errorString Описание ошибки, если соединение получить не удалось
+     * @return Открытое соединение или недействительный QSqlDatabase
+     */
+    QSqlDatabase acquire(QString* errorString = nullptr);
+
+    /**
+     * @brief Завершает аренду соединения текущего потока.
+     */
+    void release();
+
+    /**
+     * @brief Исключает соединение текущего потока из лимита простаивающих.
+     * Вызывается постоянными потоками, которые часто обращаются к БД:
+     * их соединение закрывается после аренды, только если его место
+     * ждёт другой поток.
+     */
+    void keepCurrentThreadConnection();
+
+    /**
+     * @brief Закрывает соединение текущего потока независимо от аренд.
+     * Используется при завершении работы.
+     */
+    void closeCurrentThread();
+
+    /**
+     * @brief Возвращает соединение libpq, которым пользуется драйвер QPSQL.
+     * Нужен для операций, которых нет в Qt SQL (COPY, PQcancel).
+     */
+    static PGconn* nativeHandle(const QSqlDatabase& database);
+
+    /**
+     * @brief Число запросов, взятых из кэша подготовленных запросов.
+     */
+    quint64 statementCacheHits() const;
+
+    /**
+     * @brief Число запросов, подготовленных на сервере заново.
+     */
+    quint64 statementCacheMisses() const;
+
+    static const int DEFAULT_MAX_SIZE = 8;
+    // Простаивающих соединений рабочих потоков (без keepCurrentThreadConnection())
+    static const int MAX_IDLE_CONNECTIONS = 2;
+    static const int ACQUIRE_TIMEOUT_MS = 10000;
+    static const int HEALTH_CHECK_INTERVAL_MS = 30000;
+    // Подготовленных запросов на соединение; при переполнении кэш очищается
+    static const int MAX_CACHED_STATEMENTS = 64;
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+private:
+    /**
+     * @brief Соединение одного потока. Удаляется QThreadStorage при
+     * завершении потока и при этом закрывает соединение.
+     */
+    struct ThreadConnection {
+        QString name;
+        int leases = 0;
+        bool open = false;
+        bool idle = false;
+        bool keep = false;   // не входит в лимит MAX_IDLE_CONNECTIONS
+        QElapsedTimer lastUsed;
+        QHash<QString, QSqlQuery*> statements; // кэш подготовленных запросов
+        ~ThreadConnection();
+    };
+
+    ConnectionPool();
+
+    ThreadConnection* currentConnection();
+
+    bool openConnection(ThreadConnection* connection, QString* errorString);
+    bool isHealthy(ThreadConnection* connection);
+    void closeConnection(ThreadConnection* connection);
+    QSqlQuery* preparedQuery(const QString& sql, QString* errorString);
+    void clearStatements(ThreadConnection* connection);
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_slotFreed;
+    Options m_options;
+    int m_maxSize;
+    int m_size;
+    int m_idle;
+    int m_idleWorkers;   // простаивающие соединения без keep
+    int m_waiters;
+    int m_nextId;
+    QThreadStorage<ThreadConnection*> m_connections;
+    QAtomicInteger<quint64> m_statementHits;
+    QAtomicInteger<quint64> m_statementMisses;
+};
+
+#endif // CONNECTIONPOOL_H
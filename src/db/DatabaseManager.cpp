@@ -1,4 +1,66 @@
 #include "db/DatabaseManager.h"
+#include <QElapsedTimer>
+#include <QSet>
+#include <QtConcurrent>
+#include <libpq-fe.h>
+#include "core/CryptoUtils.h"
+#include "db/ConnectionPool.h"
+#include "db/SchemaMigrator.h"
+
+namespace {
+
+// Поле текстового формата COPY: экранируются обратная косая черта и управляющие символы
+void appendCopyField(QByteArray& line, const QString& value) {
+    const QByteArray utf8 = value.toUtf8();
+    for (char c : utf8) {
+        switch (c) {
+        case '\\':
+            line += "\\\\";
+            break;
+        case '\t':
+            line += "\\t";
+            break;
+        case '\n':
+            line += "\\n";
+            break;
+        case '\r':
+            line += "\\r";
+            break;
+        default:
+            line += c;
+        }
+    }
+}
+
+// Дочитывает результаты COPY, чтобы соединение вернулось в обычный режим
+bool finishCopy(PGconn* connection, QString& errorString) {
+    bool ok = true;
+    while (PGresult* result = PQgetResult(connection)) {
+        if (PQresultStatus(result) != PGRES_COMMAND_OK) {
+            errorString = QString::fromUtf8(PQresultErrorMessage(result)).trimmed();
+            ok = false;
+        }
+        PQclear(result);
+    }
+    return ok;
+}
+
+// fail_count накапливается: в записи передаётся число новых неудачных попыток
+const char* const PROGRESS_UPSERT_SQL =
+    "INSERT INTO study_progress (user_id, chapter_id, last_score, status, fail_count) "
+    "VALUES (?, ?, ?, ?, ?) "
+    "ON CONFLICT (user_id, chapter_id) DO UPDATE SET last_score = EXCLUDED.last_score, "
+    "status = EXCLUDED.status, fail_count = study_progress.fail_count + EXCLUDED.fail_count, "
+    "updated_at = CURRENT_TIMESTAMP";
+
+// Ошибки данных (класс 22) и нарушения ограничений (класс 23) не исчезнут
+// при повторе: такую запись нужно отбросить, а не повторять пакет
+bool isPermanentError(const QSqlError& error) {
+    const QString state = error.nativeErrorCode();
+    return state.startsWith("22") || state.startsWith("23");
+}
+
+} // namespace
 
 const QString DatabaseManager::DB_HOSTNAME = "localhost";
 const QString DatabaseManager::DB_NAME = "course_db";
@@ -8,13 +70,13 @@ const int DatabaseManager::DB_PORT = 5432;
 
 DatabaseManager::DatabaseManager(QObject* parent)
     : QObject(parent), m_connected(false) {
-    m_database = QSqlDatabase::addDatabase("QPSQL");
+    // Пул создаётся раньше менеджера, чтобы быть уничтоженным позже него
+    ConnectionPool::getInstance();
 }
 
 DatabaseManager::~DatabaseManager() {
-    if (m_database.isOpen()) {
-        m_database.close();
-    }
+    m_mainLease.reset();
+    ConnectionPool::getInstance().closeCurrentThread();
 }
 
 DatabaseManager& DatabaseManager::getInstance() {
@@ -23,180 +85,84 @@ DatabaseManager& DatabaseManager::getInstance() {
 }
 
 bool DatabaseManager::connectToDatabase() {
-    if (m_connected && m_database.isOpen()) {
+    if (m_connected && m_mainLease && m_mainLease->isValid()) {
         return true;
     }
 
-    m_database.setHostName(DB_HOSTNAME);
-    m_database.setPort(DB_PORT);
-    m_database.setDatabaseName(DB_NAME);
-    m_database.setUserName(DB_USERNAME);
-    m_database.setPassword(DB_PASSWORD);
-
-    if (!m_database.open()) {
-        m_lastError = QString("Failed to connect to database: %1").arg(m_database.lastError().text());
-        qDebug() << m_lastError;
+    ConnectionPool::Options options;
+    options.hostName = DB_HOSTNAME;
+    options.port = DB_PORT;
+    options.databaseName = DB_NAME;
+    options.userName = DB_USERNAME;
+    options.password = DB_PASSWORD;
+    ConnectionPool::getInstance().setOptions(options);
+
+    // Соединение основного потока арендуется на всё время работы:
+    // модели представлений (UsersTableModel) загружают страницы без переподключения
+    m_mainLease.reset(new ConnectionPool::Lease);
+    if (!m_mainLease->isValid()) {
+        setLastError(m_mainLease->errorString());
+        m_mainLease.reset();
         m_connected = false;
         return false;
     }
 
     m_connected = true;
-    m_lastError.clear();
+    setLastError(QString());
     qDebug() << "Successfully connected to PostgreSQL database:" << DB_NAME;
     return true;
 }
 
 bool DatabaseManager::initDatabase() {
-    if (!isConnected()) {
-        m_lastError = "Database not connected";
-        return false;
-    }
-
-    // Попытка загрузки схемы из файла
-    if (loadSchemaFromFile()) {
-        qDebug() << "Database schema loaded from file successfully";
-        return true;
-    }
-
-    // Резервный вариант с жестко заданной схемой
-    qDebug() << "Loading schema from file failed, using hardcoded schema";
-    return createTables();
-}
-
-bool DatabaseManager::loadSchemaFromFile() {
-    QFile schemaFile(":/schema.sql");
-
-    if (!schemaFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        m_lastError = "Cannot open schema file from resources (:/schema.sql)";
-        qDebug() << m_lastError;
-        return false;
-    }
-
-    QTextStream in(&schemaFile);
-    QString schemaContent = in.readAll();
-    schemaFile.close();
-
-    QStringList statements = schemaContent.split(';', Qt::SkipEmptyParts);
-
-    for (const QString& statement : statements) {
-        QString trimmedStatement = statement.trimmed();
-        if (trimmedStatement.isEmpty() || trimmedStatement.startsWith("--")) {
-            continue;
-        }
-
-        QSqlQuery query(m_database);
-        if (!query.exec(trimmedStatement)) {
-            m_lastError = QString("Failed to execute schema statement: %1")
-            .arg(query.lastError().text());
-            qDebug() << m_lastError;
-            qDebug() << "Statement:" << trimmedStatement;
-            return false;
-        }
-    }
-
-    return true;
-}
-
-
-bool DatabaseManager::createTables() {
-    QSqlQuery query(m_database);
-
-    // Создание таблицы пользователей
-    QString createUsersTable = R"(
-        CREATE TABLE IF NOT EXISTS users (
-            id SERIAL PRIMARY KEY,
-            login TEXT UNIQUE NOT NULL,
-            password_hash TEXT NOT NULL,
-            role TEXT NOT NULL DEFAULT 'student',
-            created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
-        )
-    )";
-
-    if (!query.exec(createUsersTable)) {
-        m_lastError = QString("Failed to create users table: %1")
-        .arg(query.lastError().text());
-        qDebug() << m_lastError;
+    ConnectionPool::Lease lease;
+    if (!lease.isValid()) {
+        setLastError(lease.errorString());
         return false;
     }
+    QSqlDatabase database = lease.database();
 
-    // Создание таблицы прогресса обучения
-    QString createProgressTable = R"(
-        CREATE TABLE IF NOT EXISTS study_progress (
-            user_id INTEGER NOT NULL,
-            chapter_id INTEGER NOT NULL,
-            status TEXT NOT NULL DEFAULT 'not_started',
-            last_score INTEGER DEFAULT 0,
-            updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
-            PRIMARY KEY (user_id, chapter_id),
-            FOREIGN KEY (user_id) REFERENCES users(id) ON DELETE CASCADE
-        )
-    )";
-
-    if (!query.exec(createProgressTable)) {
-        m_lastError = QString("Failed to create study_progress table: %1")
-        .arg(query.lastError().text());
-        qDebug() << m_lastError;
+    // Без новых миграций это один запрос списка применённых версий
+    QString error;
+    if (!SchemaMigrator::migrate(database, error)) {
+        setLastError(error);
+        qDebug() << getLastError();
         return false;
     }
-
-    QString createAdmin = R"(
-        INSERT INTO users (login, password_hash, role)
-        VALUES (
-            'admin',
-            '8c6976e5b5410415bde908bd4dee15dfb167a9c873fc4bb8a81f6f2ab448a918',
-            'admin'
-        )
-        ON CONFLICT (login) DO NOTHING
-    )";
-    // SHA-256("admin")
-
-    if (!query.exec(createAdmin)) {
-        m_lastError = QString("Failed to create default admin user: %1")
-        .arg(query.lastError().text());
-        qDebug() << m_lastError;
-    } else {
-        if (query.numRowsAffected() > 0) {
-            qDebug() << "Default admin user 'admin' with password 'admin' created.";
-        } else {
-            qDebug() << "Default admin user 'admin' already exists.";
-        }
-    }
-
-    // Создание индексов для оптимизации запросов
-    query.exec("CREATE INDEX IF NOT EXISTS idx_users_login ON users(login)");
-    query.exec("CREATE INDEX IF NOT EXISTS idx_study_progress_user_id ON study_progress(user_id)");
-    query.exec("CREATE INDEX IF NOT EXISTS idx_study_progress_chapter_id ON study_progress(chapter_id)");
-
-    qDebug() << "Database tables created successfully";
     return true;
 }
 
-
 bool DatabaseManager::isConnected() const {
-    return m_connected && m_database.isOpen();
+    return m_connected;
 }
 
 QStringList DatabaseManager::getTableList() const {
-    if (!isConnected()) {
+    ConnectionPool::Lease lease;
+    if (!lease.isValid()) {
         return QStringList();
     }
 
-    return m_database.tables();
+    return lease.database().tables();
 }
 
 QString DatabaseManager::getLastError() const {
-    return m_lastError;
+    return m_lastError.localData();
+}
+
+void DatabaseManager::setLastError(const QString& error) {
+    m_lastError.setLocalData(error);
 }
 
 bool DatabaseManager::executeQuery(const QString& query) {
-    if (!isConnected()) {
-        m_lastError = "Database not connected";
+    ConnectionPool::Lease lease;
+    if (!lease.isValid()) {
+        setLastError(lease.errorString());
         return false;
     }
+    QSqlDatabase database = lease.database();
 
-    QSqlQuery sqlQuery(m_database);
+    QSqlQuery sqlQuery(database);
     if (!sqlQuery.exec(query)) {
-        m_lastError = QString("Query execution failed: %1").arg(sqlQuery.lastError().text());
+        setLastError(QString("Query execution failed: %1").arg(sqlQuery.lastError().text()));
         return false;
     }
 
@@ -204,28 +170,35 @@ bool DatabaseManager::executeQuery(const QString& query) {
 }
 
 QSqlQuery DatabaseManager::executeSelectQuery(const QString& query) {
-    QSqlQuery sqlQuery(m_database);
-    if (isConnected()) {
-        sqlQuery.exec(query);
+    ConnectionPool::Lease lease;
+    QSqlQuery sqlQuery(lease.database());
+    if (!lease.isValid()) {
+        setLastError(lease.errorString());
+    } else if (!sqlQuery.exec(query)) {
+        setLastError(QString("Query execution failed: %1").arg(sqlQuery.lastError().text()));
     }
     return sqlQuery;
 }
 
 bool DatabaseManager::registerUser(const QString& login, const QString& passwordHash, const QString& role) {
-    if (!isConnected()) {
-        m_lastError = "Database not connected";
+    ConnectionPool::Lease lease;
+    if (!lease.isValid()) {
+        setLastError(lease.errorString());
         return false;
     }
+    QSqlQuery* query = lease.prepare("INSERT INTO users (login, password_hash, role) VALUES (?, ?, ?)");
+    if (!query) {
+        setLastError(lease.errorString());
+        qDebug() << getLastError();
+        return false;
+    }
+    query->bindValue(0, login);
+    query->bindValue(1, passwordHash);
+    query->bindValue(2, role);
 
-    QSqlQuery query(m_database);
-    query.prepare("INSERT INTO users (login, password_hash, role) VALUES (?, ?, ?)");
-    query.addBindValue(login);
-    query.addBindValue(passwordHash);
-    query.addBindValue(role);
-
-    if (!query.exec()) {
-        m_lastError = QString("Failed to register user: %1").arg(query.lastError().text());
-        qDebug() << m_lastError;
+    if (!query->exec()) {
+        setLastError(QString("Failed to register user: %1").arg(query->lastError().text()));
+        qDebug() << getLastError();
         return false;
     }
 
@@ -233,157 +206,352 @@ bool DatabaseManager::registerUser(const QString& login, const QString& password
     return true;
 }
 
-QString DatabaseManager::authenticateUser(const QString& login, const QString& passwordHash) {
-    if (!isConnected()) {
-        m_lastError = "Database not connected";
-        return QString();
+bool DatabaseManager::getUserCredentials(const QString& login, UserCredentials& credentials) {
+    ConnectionPool::Lease lease;
+    if (!lease.isValid()) {
+        setLastError(lease.errorString());
+        return false;
+    }
+    QSqlQuery* query = lease.prepare("SELECT id, role, password_hash FROM users WHERE login = ?");
+    if (!query) {
+        setLastError(lease.errorString());
+        qDebug() << getLastError();
+        return false;
     }
+    query->bindValue(0, login);
 
-    QSqlQuery query(m_database);
-    query.prepare("SELECT role FROM users WHERE login = ? AND password_hash = ?");
-    query.addBindValue(login);
-    query.addBindValue(passwordHash);
+    if (!query->exec()) {
+        setLastError(QString("Authentication query failed: %1").arg(query->lastError().text()));
+        qDebug() << getLastError();
+        return false;
+    }
 
-    if (!query.exec()) {
-        m_lastError = QString("Authentication query failed: %1").arg(query.lastError().text());
-        qDebug() << m_lastError;
-        return QString();
+    credentials = UserCredentials();
+    if (query->next()) {
+        credentials.id = query->value(0).toInt();
+        credentials.role = query->value(1).toString();
+        credentials.passwordHash = query->value(2).toString();
+    } else {
+        qDebug() << "Unknown user:" << login;
     }
+    // Подготовленный запрос остаётся в кэше соединения, результат освобождается
+    query->finish();
+    return true;
+}
 
-    if (query.next()) {
-        QString role = query.value(0).toString();
-        qDebug() << "User authenticated successfully:" << login << "with role:" << role;
-        return role;
+bool DatabaseManager::updatePasswordHash(int userId, const QString& passwordHash) {
+    ConnectionPool::Lease lease;
+    if (!lease.isValid()) {
+        setLastError(lease.errorString());
+        return false;
+    }
+    QSqlQuery* query = lease.prepare("UPDATE users SET password_hash = ? WHERE id = ?");
+    if (!query) {
+        setLastError(lease.errorString());
+        qDebug() << getLastError();
+        return false;
+    }
+    query->bindValue(0, passwordHash);
+    query->bindValue(1, userId);
+
+    if (!query->exec()) {
+        setLastError(QString("Failed to update password hash: %1").arg(query->lastError().text()));
+        qDebug() << getLastError();
+        return false;
     }
 
-    qDebug() << "Authentication failed for user:" << login;
-    return QString();
+    qDebug() << "Password hash upgraded for user" << userId;
+    return true;
 }
 
-QPair<QString, int> DatabaseManager::authenticateUserWithId(const QString& login, const QString& passwordHash) {
-    if (!isConnected()) {
-        m_lastError = "Database not connected";
-        return QPair<QString, int>(QString(), -1);
+bool DatabaseManager::importUsers(const QList<UserImportRow>& rows, UserImportReport& report,
+                                  const std::function<bool(int, int)>& progress) {
+    QElapsedTimer timer;
+    timer.start();
+
+    auto fail = [&](const QString& error) {
+        setLastError(error);
+        report.errorString = error;
+        report.elapsedMs = timer.elapsed();
+        qDebug() << getLastError();
+        return false;
+    };
+
+    ConnectionPool::Lease lease;
+    if (!lease.isValid()) {
+        return fail(lease.errorString());
+    }
+    QSqlDatabase database = lease.database();
+    PGconn* connection = ConnectionPool::nativeHandle(database);
+    if (!connection) {
+        return fail("PostgreSQL connection handle is not available");
     }
 
-    QSqlQuery query(m_database);
-    query.prepare("SELECT id, role FROM users WHERE login = ? AND password_hash = ?");
-    query.addBindValue(login);
-    query.addBindValue(passwordHash);
+    // Повторы внутри файла отсекаются сразу, чтобы не хешировать их пароли
+    QList<UserImportRow> unique;
+    QSet<QString> seen;
+    unique.reserve(rows.size());
+    for (const UserImportRow& row : rows) {
+        if (seen.contains(row.login)) {
+            report.duplicateLogins.append(row.login);
+        } else {
+            seen.insert(row.login);
+            unique.append(row);
+        }
+    }
 
-    if (!query.exec()) {
-        m_lastError = QString("Authentication query failed: %1").arg(query.lastError().text());
-        qDebug() << m_lastError;
-        return QPair<QString, int>(QString(), -1);
+    if (!database.transaction()) {
+        return fail(QString("Failed to start import transaction: %1").arg(database.lastError().text()));
+    }
+    auto rollback = [&](const QString& error) {
+        database.rollback();
+        return fail(error);
+    };
+
+    // COPY напрямую в users прервался бы на первом существующем логине,
+    // поэтому строки сначала попадают во временную таблицу
+    QSqlQuery query(database);
+    if (!query.exec("CREATE TEMP TABLE import_users (login TEXT NOT NULL, password_hash TEXT NOT NULL, "
+                    "role TEXT NOT NULL) ON COMMIT DROP")) {
+        return rollback(QString("Failed to create import table: %1").arg(query.lastError().text()));
     }
 
-    if (query.next()) {
-        int userId = query.value(0).toInt();
-        QString role = query.value(1).toString();
-        qDebug() << "User authenticated successfully:" << login << "with role:" << role << "and ID:" << userId;
-        return QPair<QString, int>(role, userId);
+    PGresult* copyResult = PQexec(connection, "COPY import_users (login, password_hash, role) FROM STDIN");
+    const bool copyStarted = PQresultStatus(copyResult) == PGRES_COPY_IN;
+    const QString copyError = QString::fromUtf8(PQresultErrorMessage(copyResult)).trimmed();
+    PQclear(copyResult);
+    if (!copyStarted) {
+        return rollback(QString("Failed to start COPY: %1").arg(copyError));
     }
 
-    qDebug() << "Authentication failed for user:" << login;
-    return QPair<QString, int>(QString(), -1);
-}
+    // Хеширование - самая дорогая часть импорта: пакет хешируется
+    // параллельно, затем его строки уходят в поток COPY
+    const int iterations = CryptoUtils::PBKDF2_MIN_ITERATIONS;
+    const std::function<QByteArray(const UserImportRow&)> encodeRow = [iterations](const UserImportRow& row) {
+        QByteArray line;
+        appendCopyField(line, row.login);
+        line += '\t';
+        appendCopyField(line, CryptoUtils::hashPassword(row.password, iterations));
+        line += '\t';
+        appendCopyField(line, row.role);
+        line += '\n';
+        return line;
+    };
+
+    for (int start = 0; start < unique.size(); start += IMPORT_BATCH_SIZE) {
+        const QList<UserImportRow> batch = unique.mid(start, IMPORT_BATCH_SIZE);
+        const QByteArray data = QtConcurrent::blockingMapped<QByteArrayList>(batch, encodeRow).join();
+
+        if (PQputCopyData(connection, data.constData(), int(data.size())) != 1) {
+            QString error;
+            finishCopy(connection, error);
+            return rollback(QString("Failed to send COPY data: %1").arg(QString::fromUtf8(PQerrorMessage(connection))));
+        }
 
-QSqlTableModel* DatabaseManager::getUsersModel() {
-    if (!isConnected()) {
-        m_lastError = "Database not connected";
-        return nullptr;
+        if (progress && !progress(start + batch.size(), unique.size())) {
+            QString error;
+            PQputCopyEnd(connection, "import cancelled");
+            finishCopy(connection, error);
+            database.rollback();
+            report.cancelled = true;
+            report.elapsedMs = timer.elapsed();
+            qDebug() << "User import cancelled after" << start + batch.size() << "rows";
+            return false;
+        }
+    }
+
+    QString copyFinishError;
+    if (PQputCopyEnd(connection, nullptr) != 1 || !finishCopy(connection, copyFinishError)) {
+        return rollback(QString("COPY failed: %1").arg(copyFinishError));
     }
 
-    QSqlTableModel* model = new QSqlTableModel(nullptr, m_database);
-    model->setTable("users");
-    model->setEditStrategy(QSqlTableModel::OnManualSubmit);
+    if (!query.exec("INSERT INTO users (login, password_hash, role) "
+                    "SELECT login, password_hash, role FROM import_users "
+                    "ON CONFLICT (login) DO NOTHING RETURNING login")) {
+        return rollback(QString("Failed to insert imported users: %1").arg(query.lastError().text()));
+    }
 
-    // Установка заголовков столбцов
-    model->setHeaderData(0, Qt::Horizontal, "ID");
-    model->setHeaderData(1, Qt::Horizontal, "Login");
-    model->setHeaderData(2, Qt::Horizontal, "Password Hash");
-    model->setHeaderData(3, Qt::Horizontal, "Role");
-    model->setHeaderData(4, Qt::Horizontal, "Created At");
+    QSet<QString> inserted;
+    while (query.next()) {
+        inserted.insert(query.value(0).toString());
+    }
+    for (const UserImportRow& row : unique) {
+        if (!inserted.contains(row.login)) {
+            report.duplicateLogins.append(row.login);
+        }
+    }
 
-    model->select();
-    return model;
+    if (!database.commit()) {
+        return rollback(QString("Failed to commit import: %1").arg(database.lastError().text()));
+    }
+
+    report.imported = inserted.size();
+    report.elapsedMs = timer.elapsed();
+    qDebug() << "Imported" << report.imported << "users in" << report.elapsedMs << "ms,"
+             << report.duplicateLogins.size() << "duplicates";
+    return true;
 }
 
-void DatabaseManager::saveProgress(int userId, int chapterId, int score, const QString& status) {
-    if (!isConnected()) {
-        m_lastError = "Database not connected";
-        qDebug() << m_lastError;
-        return;
+bool DatabaseManager::saveProgressBatch(const QList<ProgressRecord>& records, QList<ProgressRecord>* rejected) {
+    if (records.isEmpty()) {
+        return true;
     }
 
-    QSqlQuery query(m_database);
-    query.prepare("SELECT user_id FROM study_progress WHERE user_id = ? AND chapter_id = ?");
-    query.addBindValue(userId);
-    query.addBindValue(chapterId);
+    ConnectionPool::Lease lease;
+    if (!lease.isValid()) {
+        setLastError(lease.errorString());
+        qDebug() << getLastError();
+        return false;
+    }
+    QSqlDatabase database = lease.database();
 
-    if (!query.exec()) {
-        m_lastError = QString("Failed to check existing progress: %1").arg(query.lastError().text());
-        qDebug() << m_lastError;
-        return;
+    if (!database.transaction()) {
+        setLastError(QString("Failed to start progress transaction: %1").arg(database.lastError().text()));
+        qDebug() << getLastError();
+        return false;
     }
 
-    if (query.next()) {
-        // Обновление существующей записи
-        QSqlQuery updateQuery(m_database);
-        updateQuery.prepare("UPDATE study_progress SET last_score = ?, status = ?, updated_at = CURRENT_TIMESTAMP WHERE user_id = ? AND chapter_id = ?");
-        updateQuery.addBindValue(score);
-        updateQuery.addBindValue(status);
-        updateQuery.addBindValue(userId);
-        updateQuery.addBindValue(chapterId);
+    // Точки сохранения освобождаются сразу после использования: иначе
+    // каждая строка повтора добавляла бы вложенную подтранзакцию
+    QSqlQuery savepoint(database);
+    const auto execSavepoint = [&](const char* sql) {
+        if (savepoint.exec(sql)) {
+            return true;
+        }
+        setLastError(QString("Failed to save progress batch: %1").arg(savepoint.lastError().text()));
+        qDebug() << getLastError();
+        database.rollback();
+        return false;
+    };
 
-        if (!updateQuery.exec()) {
-            m_lastError = QString("Failed to update progress: %1").arg(updateQuery.lastError().text());
-            qDebug() << m_lastError;
-        } else {
-            qDebug() << "Progress updated for user" << userId << "chapter" << chapterId << "status:" << status;
+    int dropped = 0;
+    for (int start = 0; start < records.size(); start += PROGRESS_BATCH_SIZE) {
+        const int count = qMin(PROGRESS_BATCH_SIZE, int(records.size()) - start);
+
+        QStringList rows;
+        rows.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            rows.append("(?, ?, ?, ?, ?)");
         }
-    } else {
-        // Вставка новой записи
-        QSqlQuery insertQuery(m_database);
-        insertQuery.prepare("INSERT INTO study_progress (user_id, chapter_id, last_score, status) VALUES (?, ?, ?, ?)");
-        insertQuery.addBindValue(userId);
-        insertQuery.addBindValue(chapterId);
-        insertQuery.addBindValue(score);
-        insertQuery.addBindValue(status);
-
-        if (!insertQuery.exec()) {
-            m_lastError = QString("Failed to insert progress: %1").arg(insertQuery.lastError().text());
-            qDebug() << m_lastError;
-        } else {
-            qDebug() << "Progress saved for user" << userId << "chapter" << chapterId << "status:" << status;
+
+        // Точка сохранения позволяет откатить только этот пакет
+        if (!execSavepoint("SAVEPOINT progress_chunk")) {
+            return false;
+        }
+        QSqlQuery query(database);
+        query.prepare("INSERT INTO study_progress (user_id, chapter_id, last_score, status, fail_count) VALUES "
+                      + rows.join(", ")
+                      + " ON CONFLICT (user_id, chapter_id) DO UPDATE SET last_score = EXCLUDED.last_score, "
+                        "status = EXCLUDED.status, fail_count = study_progress.fail_count + EXCLUDED.fail_count, "
+                        "updated_at = CURRENT_TIMESTAMP");
+        for (int i = start; i < start + count; ++i) {
+            const ProgressRecord& record = records[i];
+            query.addBindValue(record.userId);
+            query.addBindValue(record.chapterId);
+            query.addBindValue(record.score);
+            query.addBindValue(record.status);
+            query.addBindValue(record.failAttempts);
+        }
+
+        if (query.exec()) {
+            if (!execSavepoint("RELEASE SAVEPOINT progress_chunk")) {
+                return false;
+            }
+            continue;
+        }
+        if (!isPermanentError(query.lastError())) {
+            setLastError(QString("Failed to save progress batch: %1").arg(query.lastError().text()));
+            qDebug() << getLastError();
+            database.rollback();
+            return false;
+        }
+
+        // В пакете есть запись, которая не сохранится никогда (например,
+        // пользователь удалён): записи пакета повторяются по одной
+        if (!execSavepoint("ROLLBACK TO SAVEPOINT progress_chunk")
+            || !execSavepoint("RELEASE SAVEPOINT progress_chunk")) {
+            return false;
+        }
+        QSqlQuery row(database);
+        row.prepare(PROGRESS_UPSERT_SQL);
+        for (int i = start; i < start + count; ++i) {
+            const ProgressRecord& record = records[i];
+            if (!execSavepoint("SAVEPOINT progress_row")) {
+                return false;
+            }
+            row.bindValue(0, record.userId);
+            row.bindValue(1, record.chapterId);
+            row.bindValue(2, record.score);
+            row.bindValue(3, record.status);
+            row.bindValue(4, record.failAttempts);
+            if (row.exec()) {
+                if (!execSavepoint("RELEASE SAVEPOINT progress_row")) {
+                    return false;
+                }
+                continue;
+            }
+            if (!isPermanentError(row.lastError())) {
+                setLastError(QString("Failed to save progress batch: %1").arg(row.lastError().text()));
+                qDebug() << getLastError();
+                database.rollback();
+                return false;
+            }
+            qWarning() << "Dropping progress record for user" << record.userId << "chapter" << record.chapterId
+                       << ":" << row.lastError().text();
+            if (!execSavepoint("ROLLBACK TO SAVEPOINT progress_row")
+                || !execSavepoint("RELEASE SAVEPOINT progress_row")) {
+                return false;
+            }
+            if (rejected) {
+                rejected->append(record);
+            }
+            ++dropped;
         }
     }
-}
 
-QPair<int, QString> DatabaseManager::getLastProgress(int userId) {
-    if (!isConnected()) {
-        m_lastError = "Database not connected";
-        qDebug() << m_lastError;
-        return QPair<int, QString>(-1, QString());
+    if (!database.commit()) {
+        setLastError(QString("Failed to commit progress batch: %1").arg(database.lastError().text()));
+        qDebug() << getLastError();
+        database.rollback();
+        return false;
     }
 
-    QSqlQuery query(m_database);
-    query.prepare("SELECT chapter_id, status FROM study_progress WHERE user_id = ? ORDER BY chapter_id DESC LIMIT 1");
-    query.addBindValue(userId);
+    qDebug() << "Progress batch of" << records.size() - dropped << "records saved," << dropped << "dropped";
+    return true;
+}
+
+bool DatabaseManager::getUserProgress(int userId, QList<ProgressRecord>& records) {
+    ConnectionPool::Lease lease;
+    if (!lease.isValid()) {
+        setLastError(lease.errorString());
+        qDebug() << getLastError();
+        return false;
+    }
+    QSqlQuery* query = lease.prepare("SELECT chapter_id, last_score, status FROM study_progress "
+                                     "WHERE user_id = ? ORDER BY chapter_id");
+    if (!query) {
+        setLastError(lease.errorString());
+        qDebug() << getLastError();
+        return false;
+    }
+    query->bindValue(0, userId);
 
-    if (!query.exec()) {
-        m_lastError = QString("Failed to get last progress: %1").arg(query.lastError().text());
-        qDebug() << m_lastError;
-        return QPair<int, QString>(-1, QString());
+    if (!query->exec()) {
+        setLastError(QString("Failed to load progress: %1").arg(query->lastError().text()));
+        qDebug() << getLastError();
+        return false;
     }
 
-    if (query.next()) {
-        int chapterId = query.value(0).toInt();
-        QString status = query.value(1).toString();
-        qDebug() << "Last progress for user" << userId << ": chapter" << chapterId << "status:" << status;
-        return QPair<int, QString>(chapterId, status);
+    while (query->next()) {
+        ProgressRecord record;
+        record.userId = userId;
+        record.chapterId = query->value(0).toInt();
+        record.score = query->value(1).toInt();
+        record.status = query->value(2).toString();
+        records.append(record);
     }
+    query->finish();
 
-    qDebug() << "No progress found for user" << userId << ", starting from chapter 0";
-    return QPair<int, QString>(0, "not_started"); // Возвращаем корректный начальный статус
+    qDebug() << "Loaded" << records.size() << "progress records for user" << userId;
+    return true;
 }
@@ -2,22 +2,32 @@
 #define DATABASEMANAGER_H
 
 #include <QObject>
+#include <QScopedPointer>
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
-#include <QSqlTableModel>
 #include <QString>
 #include <QStringList>
+#include <QThreadStorage>
 #include <QDebug>
 #include <QFile>
 #include <QTextStream>
 #include <QCoreApplication>
 #include <QPair>
+#include <functional>
+#include "db/ConnectionPool.h"
+#include "db/UserImport.h"
 
 /**
  * @brief Класс для управления базой данных.
  * Реализует паттерн Singleton для работы с PostgreSQL базой данных.
  * Обеспечивает аутентификацию пользователей и отслеживание прогресса обучения.
+ *
+ * Соединения берутся из ConnectionPool: каждый метод арендует соединение
+ * своего потока на время вызова, поэтому методы можно вызывать из рабочих
+ * потоков (QtConcurrent, QThreadPool). Частые запросы (вход, регистрация,
+ * прогресс) берутся из кэша подготовленных запросов соединения
+ * (ConnectionPool::Lease::prepare) и не разбираются сервером повторно.
  */
 class DatabaseManager : public QObject
 {
@@ -38,13 +48,15 @@ public:
     
     /**
      * @brief Инициализирует структуру базы данных.
+     * Применяет недостающие миграции схемы (SchemaMigrator).
      * @return true если инициализация прошла успешно, false в противном случае
      */
     bool initDatabase();
     
     /**
-     * @brief Проверяет состояние соединения с базой данных.
-     * @return true если соединение активно, false в противном случае
+     * @brief Проверяет, было ли установлено соединение с базой данных.
+     * Работоспособность конкретного соединения проверяет пул при аренде.
+     * @return true если connectToDatabase() выполнен успешно
      */
     bool isConnected() const;
     
@@ -55,7 +67,9 @@ public:
     QStringList getTableList() const;
     
     /**
-     * @brief Получает текст последней ошибки.
+     * @brief Получает текст последней ошибки в текущем потоке.
+     * Ошибки хранятся отдельно для каждого потока, поэтому запросы из
+     * потока AsyncDatabase не затирают ошибку основного потока.
      * @return Строка с описанием последней ошибки
      */
     QString getLastError() const;
@@ -69,6 +83,8 @@ public:
     
     /**
      * @brief Выполняет SELECT запрос с возвратом данных.
+     * В рабочем потоке результат читается, пока поток держит
+     * ConnectionPool::Lease: без аренды соединение может быть закрыто.
      * @param query SQL SELECT запрос
      * @return Объект QSqlQuery с результатами запроса
      */
@@ -84,42 +100,85 @@ public:
     bool registerUser(const QString& login, const QString& passwordHash, const QString& role = "student");
     
     /**
-     * @brief Аутентифицирует пользователя по логину и паролю.
-     * @param login Логин пользователя
-     * @param passwordHash Хешированный пароль
-     * @return Роль пользователя или пустая строка при неудаче
+     * @brief Учётные данные пользователя для проверки пароля.
      */
-    QString authenticateUser(const QString& login, const QString& passwordHash);
-    
+    struct UserCredentials {
+        int id = -1;
+        QString role;
+        QString passwordHash;
+    };
+
     /**
-     * @brief Аутентифицирует пользователя и возвращает роль с ID.
+     * @brief Получает учётные данные пользователя по логину.
+     * Сам пароль проверяется вне БД (CryptoUtils::verifyPassword), так как
+     * хеши солёные и не сравниваются в SQL.
      * @param login Логин пользователя
-     * @param passwordHash Хешированный пароль
-     * @return Пара (роль, ID пользователя)
+     * @param credentials Заполняемые учётные данные; id == -1, если
+     * пользователь не найден
+     * @return true если запрос выполнен
      */
-    QPair<QString, int> authenticateUserWithId(const QString& login, const QString& passwordHash);
-    
+    bool getUserCredentials(const QString& login, UserCredentials& credentials);
+
     /**
-     * @brief Получает модель данных пользователей для отображения в таблице.
-     * @return Указатель на QSqlTableModel с данными пользователей
+     * @brief Заменяет хеш пароля пользователя (перехеширование при входе).
+     * @param userId ID пользователя
+     * @param passwordHash Новый хеш пароля
+     * @return true если хеш обновлён
      */
-    QSqlTableModel* getUsersModel();
+    bool updatePasswordHash(int userId, const QString& passwordHash);
     
     /**
-     * @brief Сохраняет прогресс студента по главе.
-     * @param userId ID пользователя
-     * @param chapterId ID главы
-     * @param score Количество баллов
-     * @param status Статус прохождения
+     * @brief Массово добавляет пользователей одной транзакцией.
+     * Пароли хешируются параллельно на всех ядрах пакетами по
+     * IMPORT_BATCH_SIZE, строки потоково передаются через
+     * COPY ... FROM STDIN во временную таблицу, откуда переносятся в users
+     * с ON CONFLICT (login) DO NOTHING. Уже существующие и повторяющиеся
+     * в списке логины попадают в report.duplicateLogins, остальные
+     * добавляются. Хеши создаются с CryptoUtils::PBKDF2_MIN_ITERATIONS
+     * и усиливаются при первом входе пользователя.
+     * @param rows Пользователи из UserCsvReader
+     * @param report Заполняются imported, duplicateLogins, cancelled и elapsedMs
+     * @param progress Вызывается после каждого пакета (обработано, всего);
+     * возврат false отменяет импорт с откатом транзакции
+     * @return true если транзакция зафиксирована
      */
-    void saveProgress(int userId, int chapterId, int score, const QString &status);
+    bool importUsers(const QList<UserImportRow>& rows, UserImportReport& report,
+                     const std::function<bool(int, int)>& progress = nullptr);
+
+    /**
+     * @brief Запись прогресса студента по одной главе.
+     */
+    struct ProgressRecord {
+        int userId = -1;
+        int chapterId = -1;
+        int score = 0;
+        QString status;
+        int failAttempts = 0;   // неудачных попыток с прошлой записи в БД
+    };
+
+    /**
+     * @brief Сохраняет несколько записей прогресса одной транзакцией.
+     * Записи отправляются многострочными INSERT ... ON CONFLICT DO UPDATE
+     * по PROGRESS_BATCH_SIZE строк. Пары (user_id, chapter_id) в списке
+     * не должны повторяться (см. ProgressWriter).
+     * Если пакет нарушает ограничение или содержит неверные данные
+     * (SQLSTATE классов 22 и 23), его записи повторяются по одной под
+     * точками сохранения, а отвергнутые отбрасываются с записью в лог:
+     * одна такая запись не откатывает прогресс остальных.
+     * @param records Записи прогресса
+     * @param rejected Заполняется отброшенными записями
+     * @return true если транзакция зафиксирована; false при ошибке,
+     * которую имеет смысл повторить (соединение, таймаут)
+     */
+    bool saveProgressBatch(const QList<ProgressRecord>& records, QList<ProgressRecord>* rejected = nullptr);
     
     /**
-     * @brief Получает последний прогресс студента.
+     * @brief Загружает весь прогресс студента одним запросом.
      * @param userId ID пользователя
-     * @return Пара (ID последней главы, статус)
+     * @param records Заполняется записями по главам (по возрастанию chapter_id)
+     * @return true если запрос выполнен
      */
-    QPair<int, QString> getLastProgress(int userId);
+    bool getUserProgress(int userId, QList<ProgressRecord>& records);
 
     DatabaseManager(const DatabaseManager&) = delete;
     DatabaseManager& operator=(const DatabaseManager&) = delete;
@@ -127,9 +186,12 @@ public:
 private:
     explicit DatabaseManager(QObject *parent = nullptr);
     ~DatabaseManager();
-    
-    bool createTables();
-    bool loadSchemaFromFile();
+
+    // Пользователей в одном пакете хеширования и COPY
+    static const int IMPORT_BATCH_SIZE = 64;
+    // Строк в одном INSERT при пакетном сохранении прогресса (5 параметров на строку)
+    static const int PROGRESS_BATCH_SIZE = 500;
+    void setLastError(const QString& error);
 
     static const QString DB_HOSTNAME;
     static const QString DB_NAME;
@@ -137,8 +199,9 @@ private:
     static const QString DB_PASSWORD;
     static const int DB_PORT;
     
-    QSqlDatabase m_database;
-    QString m_lastError;
+    // Соединение основного потока, арендованное на всё время работы
+    QScopedPointer<ConnectionPool::Lease> m_mainLease;
+    mutable QThreadStorage<QString> m_lastError;
     bool m_connected;
 };
 
@@ -0,0 +1,95 @@
+#include "db/ProgressCache.h"
+#include <QDebug>
+#include "db/ProgressWriter.h"
+
+ProgressCache::ProgressCache(int userId, QObject* parent)
+    : QObject(parent), m_userId(userId), m_loaded(false) {
+    connect(&m_loadWatcher, &QFutureWatcherBase::finished, this, &ProgressCache::onProgressLoaded);
+}
+
+void ProgressCache::load() {
+    if (m_loadWatcher.isRunning()) {
+        return;
+    }
+    m_loadWatcher.setFuture(AsyncDatabase::getInstance().getUserProgress(m_userId));
+}
+
+bool ProgressCache::isLoaded() const {
+    return m_loaded;
+}
+
+QString ProgressCache::lastError() const {
+    return m_lastError;
+}
+
+QString ProgressCache::status(int chapterId) const {
+    return m_records.value(chapterId).status;
+}
+
+bool ProgressCache::isCompleted(int chapterId) const {
+    return status(chapterId) == "completed";
+}
+
+int ProgressCache::resumeChapter(int chapterCount, bool* courseCompleted) const {
+    if (courseCompleted) {
+        *courseCompleted = false;
+    }
+    if (m_records.isEmpty() || chapterCount <= 0) {
+        return 0;
+    }
+
+    int lastChapterId = -1;
+    for (auto it = m_records.cbegin(); it != m_records.cend(); ++it) {
+        lastChapterId = qMax(lastChapterId, it.key());
+    }
+
+    int chapter = lastChapterId;
+    if (isCompleted(lastChapterId)) {
+        chapter = lastChapterId + 1;
+        if (chapter >= chapterCount) {
+            if (courseCompleted) {
+                *courseCompleted = true;
+            }
+            chapter = chapterCount - 1;
+        }
+    }
+    return (chapter < 0 || chapter >= chapterCount) ? 0 : chapter;
+}
+
+void ProgressCache::setProgress(int chapterId, int score, const QString& status) {
+    DatabaseManager::ProgressRecord& record = m_records[chapterId];
+    record.userId = m_userId;
+    record.chapterId = chapterId;
+    record.score = score;
+    record.status = status;
+
+    ProgressWriter::getInstance().enqueue(m_userId, chapterId, score, status);
+}
+
+void ProgressCache::onProgressLoaded() {
+    if (m_loadWatcher.isCanceled() || m_loadWatcher.future().resultCount() == 0) {
+        return;
+    }
+
+    const QueryResult<QList<DatabaseManager::ProgressRecord>> result = m_loadWatcher.result();
+    m_loaded = result.ok;
+    if (!result.ok) {
+        m_lastError = result.errorString;
+        qWarning() << "Failed to load progress for user" << m_userId << ":" << m_lastError;
+    } else {
+        m_lastError.clear();
+        // Записи, сделанные до окончания загрузки, новее строк из БД
+        for (const DatabaseManager::ProgressRecord& record : result.value) {
+            if (!m_records.contains(record.chapterId)) {
+                m_records.insert(record.chapterId, record);
+            }
+        }
+    }
+
+    // Очередь ProgressWriter ещё не записана в БД и тоже новее
+    for (const DatabaseManager::ProgressRecord& record : ProgressWriter::getInstance().pendingFor(m_userId)) {
+        m_records.insert(record.chapterId, record);
+    }
+
+    emit loaded(result.ok);
+}
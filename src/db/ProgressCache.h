@@ -0,0 +1,93 @@
+#ifndef PROGRESSCACHE_H
+#define PROGRESSCACHE_H
+
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include "db/AsyncDatabase.h"
+#include "db/DatabaseManager.h"
+
+/**
+ * @brief Прогресс студента в памяти на время сеанса.
+ *
+ * Все строки study_progress пользователя загружаются одним запросом
+ * в потоке БД (load()), поверх них накладываются записи, ещё ожидающие
+ * в очереди ProgressWriter. Дальше выбор главы для продолжения и статусы
+ * глав берутся из памяти без обращений к серверу.
+ *
+ * Запись (setProgress()) сразу обновляет кэш и ставит запись в очередь
+ * ProgressWriter (write-behind), поэтому кэш всегда не старше очереди.
+ * Используется из основного потока.
+ */
+class ProgressCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Создаёт пустой кэш прогресса пользователя.
+     * @param userId ID пользователя
+     * @param parent Родительский объект
+     */
+    explicit ProgressCache(int userId, QObject* parent = nullptr);
+
+    /**
+     * @brief Загружает прогресс пользователя; по завершении испускается loaded().
+     */
+    void load();
+
+    /**
+     * @brief Загружен ли прогресс из БД.
+     */
+    bool isLoaded() const;
+
+    /**
+     * @brief Текст ошибки последней загрузки.
+     */
+    QString lastError() const;
+
+    /**
+     * @brief Статус главы или пустая строка, если записи нет.
+     */
+    QString status(int chapterId) const;
+
+    /**
+     * @brief Пройдена ли глава.
+     */
+    bool isCompleted(int chapterId) const;
+
+    /**
+     * @brief Глава, с которой продолжается обучение.
+     * После пройденной последней записанной главы - следующая,
+     * иначе - сама эта глава; без записей - первая.
+     * @param chapterCount Число глав в курсе
+     * @param courseCompleted Устанавливается в true, если пройдена последняя глава курса
+     */
+    int resumeChapter(int chapterCount, bool* courseCompleted = nullptr) const;
+
+    /**
+     * @brief Сохраняет результат главы в кэше и ставит его в очередь записи в БД.
+     */
+    void setProgress(int chapterId, int score, const QString& status);
+
+signals:
+    /**
+     * @brief Загрузка завершена.
+     * @param ok false, если прогресс не удалось загрузить (кэш содержит
+     * только записи из очереди ProgressWriter)
+     */
+    void loaded(bool ok);
+
+private slots:
+    void onProgressLoaded();
+
+private:
+    int m_userId;
+    bool m_loaded;
+    QString m_lastError;
+    QHash<int, DatabaseManager::ProgressRecord> m_records; // по chapter_id
+    QFutureWatcher<QueryResult<QList<DatabaseManager::ProgressRecord>>> m_loadWatcher;
+};
+
+#endif // PROGRESSCACHE_H
@@ -0,0 +1,289 @@
+#include "db/ProgressWriter.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include "db/AsyncDatabase.h"
+
+const QString ProgressWriter::PENDING_FILE_NAME = "pending_progress.json";
+
+ProgressWriter::ProgressWriter(QObject* parent)
+    : QObject(parent), m_nextBatchId(0), m_writeBehind(true) {
+    // Поток БД создаётся раньше, чтобы пережить очередь прогресса
+    AsyncDatabase::getInstance();
+
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(FLUSH_INTERVAL_MS);
+    connect(&m_flushTimer, &QTimer::timeout, this, &ProgressWriter::flush);
+}
+
+ProgressWriter::~ProgressWriter() {
+    // Задания потока БД ссылаются на this и должны завершиться раньше
+    shutdown();
+}
+
+ProgressWriter& ProgressWriter::getInstance() {
+    static ProgressWriter instance;
+    return instance;
+}
+
+void ProgressWriter::enqueue(int userId, int chapterId, int score, const QString& status) {
+    int pending = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        // Статус и баллы заменяются последними, неудачные попытки суммируются
+        DatabaseManager::ProgressRecord& record = m_pending[ProgressKey(userId, chapterId)];
+        record.userId = userId;
+        record.chapterId = chapterId;
+        record.score = score;
+        record.status = status;
+        if (status == "fail") {
+            ++record.failAttempts;
+        }
+        pending = m_pending.size();
+    }
+
+    if (!m_writeBehind || pending >= FLUSH_BATCH_SIZE) {
+        flush();
+    } else if (!m_flushTimer.isActive()) {
+        // Таймер не перезапускается: первая запись ждёт не дольше интервала
+        m_flushTimer.start();
+    }
+}
+
+void ProgressWriter::flush() {
+    m_flushTimer.stop();
+    const QList<DatabaseManager::ProgressRecord> records = takePending();
+    if (records.isEmpty()) {
+        return;
+    }
+
+    // Пакет остаётся в m_inFlight, пока не будет зафиксирован: задание может
+    // вовсе не выполниться (нет соединения), и тогда пакет вернётся в очередь
+    int batchId = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        batchId = ++m_nextBatchId;
+        m_inFlight.insert(batchId, records);
+    }
+
+    // Без таймаута: пакет не снимается с очереди потока БД, пока ждёт
+    QFutureWatcher<QueryResult<bool>>* watcher = new QFutureWatcher<QueryResult<bool>>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, batchId]() {
+        watcher->deleteLater();
+        const bool saved = !watcher->isCanceled() && watcher->future().resultCount() > 0
+                           && watcher->result().ok;
+        if (saved) {
+            return;
+        }
+
+        QList<DatabaseManager::ProgressRecord> failed;
+        {
+            QMutexLocker locker(&m_mutex);
+            failed = m_inFlight.take(batchId);
+        }
+        if (failed.isEmpty()) {
+            return;
+        }
+        requeue(failed);
+        if (!m_flushTimer.isActive()) {
+            m_flushTimer.start();
+        }
+    });
+    watcher->setFuture(AsyncDatabase::getInstance().run<bool>([this, records, batchId](bool& saved) {
+        // Отвергнутые сервером записи отброшены и не повторяются
+        saved = DatabaseManager::getInstance().saveProgressBatch(records);
+        if (saved) {
+            {
+                QMutexLocker locker(&m_mutex);
+                m_inFlight.remove(batchId);
+            }
+            markSaved(records);
+        }
+        return saved;
+    }, 0));
+}
+
+void ProgressWriter::setWriteBehind(bool enabled) {
+    m_writeBehind = enabled;
+    if (!enabled) {
+        flush();
+    }
+}
+
+bool ProgressWriter::isWriteBehind() const {
+    return m_writeBehind;
+}
+
+int ProgressWriter::pendingCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_pending.size();
+}
+
+QList<DatabaseManager::ProgressRecord> ProgressWriter::pendingFor(int userId) const {
+    QList<DatabaseManager::ProgressRecord> records;
+    QMutexLocker locker(&m_mutex);
+    for (const DatabaseManager::ProgressRecord& record : m_pending) {
+        if (record.userId == userId) {
+            records.append(record);
+        }
+    }
+    return records;
+}
+
+QList<DatabaseManager::ProgressRecord> ProgressWriter::takePending() {
+    QMutexLocker locker(&m_mutex);
+    const QList<DatabaseManager::ProgressRecord> records = m_pending.values();
+    m_pending.clear();
+    return records;
+}
+
+void ProgressWriter::requeue(const QList<DatabaseManager::ProgressRecord>& records) {
+    QMutexLocker locker(&m_mutex);
+    for (const DatabaseManager::ProgressRecord& record : records) {
+        const ProgressKey key(record.userId, record.chapterId);
+        auto it = m_pending.find(key);
+        if (it == m_pending.end()) {
+            m_pending.insert(key, record);
+        } else {
+            // Более новая запись остаётся, попытки из пакета не теряются
+            it->failAttempts += record.failAttempts;
+        }
+    }
+    qWarning() << "Progress batch failed," << m_pending.size() << "records pending";
+}
+
+void ProgressWriter::markSaved(const QList<DatabaseManager::ProgressRecord>& records) {
+    QMutexLocker locker(&m_mutex);
+    if (m_restoredKeys.isEmpty()) {
+        return;
+    }
+    for (const DatabaseManager::ProgressRecord& record : records) {
+        m_restoredKeys.remove(ProgressKey(record.userId, record.chapterId));
+    }
+    if (m_restoredKeys.isEmpty()) {
+        QFile::remove(pendingFilePath());
+        qInfo() << "Restored progress records saved, pending progress file removed";
+    }
+}
+
+void ProgressWriter::restorePending() {
+    QFile file(pendingFilePath());
+    if (!file.exists()) {
+        return;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Cannot open pending progress file:" << file.errorString();
+        return;
+    }
+
+    const QJsonArray array = QJsonDocument::fromJson(file.readAll()).array();
+    file.close();
+
+    int restored = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (const QJsonValue& value : array) {
+            const QJsonObject object = value.toObject();
+            DatabaseManager::ProgressRecord record;
+            record.userId = object.value("user_id").toInt(-1);
+            record.chapterId = object.value("chapter_id").toInt(-1);
+            record.score = object.value("score").toInt();
+            record.status = object.value("status").toString();
+            record.failAttempts = object.value("fail_attempts").toInt();
+            if (record.userId < 0 || record.chapterId < 0 || record.status.isEmpty()) {
+                continue;
+            }
+            // Записи текущего сеанса новее сохранённых
+            const ProgressKey key(record.userId, record.chapterId);
+            auto it = m_pending.find(key);
+            if (it == m_pending.end()) {
+                m_pending.insert(key, record);
+                ++restored;
+            } else {
+                it->failAttempts += record.failAttempts;
+            }
+            m_restoredKeys.insert(key);
+        }
+    }
+
+    // Файл удаляется в markSaved() после сохранения всех записей из него
+    qInfo() << "Restored" << restored << "pending progress records";
+    if (m_restoredKeys.isEmpty()) {
+        file.remove();
+    } else {
+        flush();
+    }
+}
+
+void ProgressWriter::shutdown() {
+    m_flushTimer.stop();
+
+    // Отправленные пакеты завершаются первыми; незафиксированные
+    // возвращаются в очередь, начиная с более новых
+    AsyncDatabase::getInstance().shutdown();
+    QList<QList<DatabaseManager::ProgressRecord>> unfinished;
+    {
+        QMutexLocker locker(&m_mutex);
+        unfinished = m_inFlight.values();
+        m_inFlight.clear();
+    }
+    for (auto it = unfinished.crbegin(); it != unfinished.crend(); ++it) {
+        requeue(*it);
+    }
+
+    const QList<DatabaseManager::ProgressRecord> records = takePending();
+    if (records.isEmpty()) {
+        return;
+    }
+
+    if (DatabaseManager::getInstance().saveProgressBatch(records)) {
+        qInfo() << "Flushed" << records.size() << "pending progress records at shutdown";
+        markSaved(records);
+        return;
+    }
+
+    // Файл перезаписывается текущим остатком очереди, в том числе
+    // ещё не сохранёнными восстановленными записями
+    {
+        QMutexLocker locker(&m_mutex);
+        m_restoredKeys.clear();
+    }
+    if (savePendingFile(records)) {
+        qWarning() << records.size() << "progress records saved to" << pendingFilePath()
+                   << "and will be written on next start";
+    }
+}
+
+QString ProgressWriter::pendingFilePath() {
+    const QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dataPath);
+    return QDir(dataPath).filePath(PENDING_FILE_NAME);
+}
+
+bool ProgressWriter::savePendingFile(const QList<DatabaseManager::ProgressRecord>& records) {
+    QJsonArray array;
+    for (const DatabaseManager::ProgressRecord& record : records) {
+        QJsonObject object;
+        object.insert("user_id", record.userId);
+        object.insert("chapter_id", record.chapterId);
+        object.insert("score", record.score);
+        object.insert("status", record.status);
+        object.insert("fail_attempts", record.failAttempts);
+        array.append(object);
+    }
+
+    QSaveFile file(pendingFilePath());
+    if (!file.open(QIODevice::WriteOnly)
+        || file.write(QJsonDocument(array).toJson(QJsonDocument::Compact)) < 0
+        || !file.commit()) {
+        qCritical() << "Failed to save pending progress:" << file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,141 @@
+#ifndef PROGRESSWRITER_H
+#define PROGRESSWRITER_H
+
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+#include "db/DatabaseManager.h"
+
+/**
+ * @brief Отложенная (write-behind) запись прогресса студентов.
+ *
+ * Результаты тестов не отправляются в БД по одному: они собираются в
+ * очередь, где повторные записи по той же главе схлопываются (остаётся
+ * последняя, а число неудачных попыток суммируется), и сбрасываются
+ * одним пакетом DatabaseManager::saveProgressBatch в потоке AsyncDatabase.
+ *
+ * - Ограничение по времени: запись ждёт в очереди не дольше
+ *   FLUSH_INTERVAL_MS; при FLUSH_BATCH_SIZE записях пакет уходит сразу.
+ * - Ошибки: пакет, который не был зафиксирован (ошибка запроса или нет
+ *   соединения), возвращается в очередь (если по главе ещё нет более новой
+ *   записи) и повторяется при следующем сбросе. Пакеты отправляются без
+ *   таймаута, чтобы не сниматься с очереди потока БД. Повторяются только
+ *   временные ошибки; записи, нарушающие ограничения (например, удалённого
+ *   пользователя), отбрасываются в saveProgressBatch, не задерживая остальные.
+ * - Завершение работы: shutdown() синхронно записывает остаток, а если
+ *   БД недоступна - сохраняет его в PENDING_FILE_NAME; restorePending()
+ *   при следующем запуске возвращает записи в очередь. Файл удаляется
+ *   только после того, как все восстановленные записи сохранены в БД.
+ *   Деструктор тоже вызывает shutdown(), поэтому задания потока БД
+ *   не переживают объект.
+ *
+ * Без отложенной записи (setWriteBehind(false)) каждая запись
+ * отправляется сразу, но так же в потоке БД.
+ * Методы вызываются из основного потока.
+ */
+class ProgressWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Получает единственный экземпляр класса (Singleton).
+     */
+    static ProgressWriter& getInstance();
+
+    /**
+     * @brief Ставит запись прогресса в очередь.
+     * @param userId ID пользователя
+     * @param chapterId ID главы
+     * @param score Количество баллов
+     * @param status Статус прохождения
+     */
+    void enqueue(int userId, int chapterId, int score, const QString& status);
+
+    /**
+     * @brief Отправляет накопленные записи в поток БД, не дожидаясь ответа.
+     */
+    void flush();
+
+    /**
+     * @brief Включает или отключает отложенную запись (по умолчанию включена).
+     */
+    void setWriteBehind(bool enabled);
+    bool isWriteBehind() const;
+
+    /**
+     * @brief Количество записей, ещё не отправленных в БД.
+     */
+    int pendingCount() const;
+
+    /**
+     * @brief Записи пользователя, ещё не отправленные в БД.
+     * Нужны, чтобы загруженный из БД прогресс не отставал от очереди.
+     */
+    QList<DatabaseManager::ProgressRecord> pendingFor(int userId) const;
+
+    /**
+     * @brief Возвращает в очередь записи, сохранённые при прошлом завершении.
+     * Вызывается после подключения к БД.
+     */
+    void restorePending();
+
+    /**
+     * @brief Дожидается отправленных пакетов и синхронно записывает остаток.
+     * Что не удалось записать, сохраняется в файл для следующего запуска.
+     * Должен вызываться на каждом пути выхода из приложения; повторный
+     * вызов безопасен.
+     */
+    void shutdown();
+
+    // Максимальное время ожидания записи в очереди
+    static const int FLUSH_INTERVAL_MS = 2000;
+    // Размер очереди, при котором пакет отправляется без ожидания
+    static const int FLUSH_BATCH_SIZE = 200;
+
+    static const QString PENDING_FILE_NAME;
+
+    ProgressWriter(const ProgressWriter&) = delete;
+    ProgressWriter& operator=(const ProgressWriter&) = delete;
+
+private:
+    explicit ProgressWriter(QObject* parent = nullptr);
+    ~ProgressWriter();
+
+    typedef QPair<int, int> ProgressKey; // (user_id, chapter_id)
+
+    /**
+     * @brief Забирает все записи из очереди.
+     */
+    QList<DatabaseManager::ProgressRecord> takePending();
+
+    /**
+     * @brief Возвращает неудавшийся пакет в очередь, не затирая более новые записи.
+     */
+    void requeue(const QList<DatabaseManager::ProgressRecord>& records);
+
+    /**
+     * @brief Отмечает записи сохранёнными; когда сохранены все записи
+     * из PENDING_FILE_NAME, файл удаляется. Вызывается из потока БД.
+     */
+    void markSaved(const QList<DatabaseManager::ProgressRecord>& records);
+
+    static QString pendingFilePath();
+    bool savePendingFile(const QList<DatabaseManager::ProgressRecord>& records);
+
+    mutable QMutex m_mutex;
+    QHash<ProgressKey, DatabaseManager::ProgressRecord> m_pending;
+    QMap<int, QList<DatabaseManager::ProgressRecord>> m_inFlight; // отправленные, ещё не зафиксированные пакеты
+    int m_nextBatchId;
+    QSet<ProgressKey> m_restoredKeys; // записи из файла, ещё не сохранённые в БД
+    QTimer m_flushTimer;
+    bool m_writeBehind;
+};
+
+#endif // PROGRESSWRITER_H
@@ -0,0 +1,218 @@
+#include "db/ReportGenerator.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QtConcurrent>
+#include "db/ConnectionPool.h"
+
+namespace {
+
+// Сводка поддерживается триггером на study_progress: одна строка на студента
+const char* const REPORT_QUERY = R"(
+    SELECT
+        u.login,
+        COALESCE(s.completed_chapters, 0) AS completed_chapters,
+        s.last_activity,
+        COALESCE(s.failed_chapters, 0) AS failed_chapters,
+        COALESCE(s.fail_attempts, 0) AS fail_attempts
+    FROM
+        users u
+    LEFT JOIN
+        student_progress_summary s ON s.user_id = u.id
+    WHERE
+        u.role = 'student'
+    ORDER BY
+        completed_chapters DESC,
+        u.login
+)";
+
+// Поле CSV заключается в кавычки, если содержит разделитель, кавычку или перевод строки
+QString csvField(const QString& value) {
+    if (!value.contains(QLatin1Char(',')) && !value.contains(QLatin1Char('"'))
+        && !value.contains(QLatin1Char('\n')) && !value.contains(QLatin1Char('\r'))) {
+        return value;
+    }
+    QString escaped = value;
+    escaped.replace("\"", "\"\"");
+    return "\"" + escaped + "\"";
+}
+
+} // namespace
+
+ReportGenerator::Format ReportGenerator::formatForFile(const QString& path) {
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix == "csv") {
+        return Format::Csv;
+    }
+    if (suffix == "jsonl" || suffix == "json") {
+        return Format::JsonLines;
+    }
+    return Format::Text;
+}
+
+QFuture<ReportGenerator::Result> ReportGenerator::generate(const QString& path, Format format, int chapterCount) {
+    return QtConcurrent::run(&ReportGenerator::run, path, format, chapterCount);
+}
+
+void ReportGenerator::run(QPromise<Result>& promise, const QString& path, Format format, int chapterCount) {
+    QElapsedTimer timer;
+    timer.start();
+    Result result;
+
+    auto finish = [&](const QString& error) {
+        result.ok = error.isEmpty();
+        result.errorString = error;
+        result.elapsedMs = timer.elapsed();
+        if (!error.isEmpty()) {
+            qWarning() << "Report failed:" << error;
+        }
+        promise.addResult(result);
+    };
+
+    ConnectionPool::Lease lease;
+    if (!lease.isValid()) {
+        finish(lease.errorString());
+        return;
+    }
+    QSqlDatabase database = lease.database();
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+
+    // Диапазон прогресса - число студентов (строк отчета)
+    if (!query.exec("SELECT COUNT(*) FROM users WHERE role = 'student'") || !query.next()) {
+        finish(QString("Failed to count students: %1").arg(query.lastError().text()));
+        return;
+    }
+    const int total = query.value(0).toInt();
+    query.finish();
+    promise.setProgressRange(0, total);
+    promise.setProgressValue(0);
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        finish(QString("Cannot open report file: %1").arg(file.errorString()));
+        return;
+    }
+
+    if (format == Format::Text) {
+        QString header;
+        header += "=== ОТЧЕТ ПО УСПЕВАЕМОСТИ СТУДЕНТОВ ===\n";
+        header += QString("Всего глав в курсе: %1\n").arg(chapterCount);
+        header += QString("Дата создания отчета: %1\n\n")
+                      .arg(QDateTime::currentDateTime().toString("dd.MM.yyyy hh:mm:ss"));
+        header += QString("%1 | %2 | %3 | %4\n")
+                      .arg("Логин студента", -20)
+                      .arg("Глав пройдено", -15)
+                      .arg("Не сдано", -10)
+                      .arg("Последняя активность");
+        header += QString(73, '-') + "\n";
+        file.write(header.toUtf8());
+    } else if (format == Format::Csv) {
+        file.write("login,completed_chapters,failed_chapters,fail_attempts,last_activity\n");
+    }
+
+    // Курсор существует только внутри транзакции
+    if (!database.transaction()) {
+        file.cancelWriting();
+        finish(QString("Failed to start report transaction: %1").arg(database.lastError().text()));
+        return;
+    }
+    auto abort = [&](const QString& error) {
+        database.rollback();
+        file.cancelWriting();
+        finish(error);
+    };
+
+    if (!query.exec(QString("DECLARE report_cursor NO SCROLL CURSOR FOR %1").arg(REPORT_QUERY))) {
+        abort(QString("Failed to declare report cursor: %1").arg(query.lastError().text()));
+        return;
+    }
+
+    const QString fetchSql = QString("FETCH FORWARD %1 FROM report_cursor").arg(FETCH_SIZE);
+    for (;;) {
+        if (promise.isCanceled()) {
+            database.rollback();
+            file.cancelWriting();
+            qInfo() << "Report cancelled after" << result.rows << "rows";
+            return;
+        }
+
+        if (!query.exec(fetchSql)) {
+            abort(QString("Failed to fetch report rows: %1").arg(query.lastError().text()));
+            return;
+        }
+
+        // Пакет форматируется целиком и записывается одним вызовом
+        QByteArray chunk;
+        int fetched = 0;
+        while (query.next()) {
+            ++fetched;
+            const QString login = query.value(0).toString();
+            const int completedCount = query.value(1).toInt();
+            const QDateTime lastActivity = query.value(2).toDateTime();
+            const int failedCount = query.value(3).toInt();
+            const int failAttempts = query.value(4).toInt();
+
+            switch (format) {
+            case Format::Text:
+                chunk += QString("%1 | %2 | %3 | %4\n")
+                             .arg(login, -20)
+                             .arg(QString::number(completedCount), -15)
+                             .arg(QString::number(failedCount), -10)
+                             .arg(lastActivity.isNull() ? QString("Нет активности")
+                                                        : lastActivity.toString("dd.MM.yyyy hh:mm"))
+                             .toUtf8();
+                break;
+            case Format::Csv:
+                chunk += QString("%1,%2,%3,%4,%5\n")
+                             .arg(csvField(login))
+                             .arg(completedCount)
+                             .arg(failedCount)
+                             .arg(failAttempts)
+                             .arg(lastActivity.isNull() ? QString() : lastActivity.toString(Qt::ISODate))
+                             .toUtf8();
+                break;
+            case Format::JsonLines: {
+                QJsonObject object;
+                object.insert("login", login);
+                object.insert("completed_chapters", completedCount);
+                object.insert("failed_chapters", failedCount);
+                object.insert("fail_attempts", failAttempts);
+                object.insert("last_activity", lastActivity.isNull() ? QJsonValue()
+                                                                     : QJsonValue(lastActivity.toString(Qt::ISODate)));
+                chunk += QJsonDocument(object).toJson(QJsonDocument::Compact);
+                chunk += '\n';
+                break;
+            }
+            }
+        }
+
+        if (fetched == 0) {
+            break;
+        }
+        if (file.write(chunk) != chunk.size()) {
+            abort(QString("Failed to write report: %1").arg(file.errorString()));
+            return;
+        }
+        result.rows += fetched;
+        promise.setProgressValue(int(qMin<qint64>(result.rows, total)));
+    }
+
+    query.exec("CLOSE report_cursor");
+    // Транзакция только читала данные
+    database.commit();
+
+    if (!file.commit()) {
+        finish(QString("Failed to save report: %1").arg(file.errorString()));
+        return;
+    }
+
+    qInfo() << "Report with" << result.rows << "rows written to" << path << "in" << timer.elapsed() << "ms";
+    finish(QString());
+}
@@ -0,0 +1,66 @@
+#ifndef REPORTGENERATOR_H
+#define REPORTGENERATOR_H
+
+#include <QFuture>
+#include <QPromise>
+#include <QString>
+
+/**
+ * @brief Потоковое формирование отчета по успеваемости студентов.
+ *
+ * Отчет строится в рабочем потоке (QtConcurrent) на собственном соединении
+ * из ConnectionPool. Результат запроса читается через серверный курсор
+ * (DECLARE ... FETCH) пакетами по FETCH_SIZE строк, и каждый пакет сразу
+ * записывается в файл, поэтому расход памяти не зависит от числа студентов.
+ *
+ * Прогресс сообщается через QFuture (progressValue в строках), отмена -
+ * через QFuture::cancel(): запись прекращается после текущего пакета,
+ * а целевой файл остаётся без изменений (QSaveFile). Отменённый QFuture
+ * не содержит результата.
+ */
+class ReportGenerator
+{
+public:
+    /**
+     * @brief Формат файла отчета.
+     */
+    enum class Format {
+        Text,       // выровненная таблица для чтения
+        Csv,        // RFC 4180, разделитель ","
+        JsonLines   // один JSON-объект на строку
+    };
+
+    /**
+     * @brief Итог формирования отчета.
+     */
+    struct Result {
+        bool ok = false;
+        qint64 rows = 0;
+        qint64 elapsedMs = 0;
+        QString errorString;
+    };
+
+    /**
+     * @brief Определяет формат по расширению файла (.csv, .jsonl, иначе текст).
+     */
+    static Format formatForFile(const QString& path);
+
+    /**
+     * @brief Запускает формирование отчета в рабочем потоке.
+     * @param path Путь к файлу отчета
+     * @param format Формат файла
+     * @param chapterCount Число глав курса для заголовка текстового отчета
+     * @return QFuture с итогом; диапазон прогресса - число студентов
+     */
+    static QFuture<Result> generate(const QString& path, Format format, int chapterCount);
+
+    // Строк в одном FETCH из курсора
+    static const int FETCH_SIZE = 500;
+
+private:
+    static void run(QPromise<Result>& promise, const QString& path, Format format, int chapterCount);
+
+    ReportGenerator() = delete;
+};
+
+#endif // REPORTGENERATOR_H
@@ -0,0 +1,238 @@
+#include "db/SchemaMigrator.h"
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRegularExpression>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTextStream>
+#include <algorithm>
+
+const QString SchemaMigrator::MIGRATIONS_PATH = ":/migrations";
+
+bool SchemaMigrator::migrate(QSqlDatabase& database, QString& errorString) {
+    QList<Migration> migrations;
+    if (!findMigrations(migrations, errorString)) {
+        return false;
+    }
+
+    QList<int> applied;
+    if (!appliedVersions(database, applied, errorString)) {
+        return false;
+    }
+
+    auto hasPending = [&migrations](const QList<int>& versions) {
+        return std::any_of(migrations.cbegin(), migrations.cend(), [&versions](const Migration& migration) {
+            return !versions.contains(migration.version);
+        });
+    };
+    if (!hasPending(applied)) {
+        qDebug() << "Database schema is up to date, version" << (migrations.isEmpty() ? 0 : migrations.last().version);
+        return true;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    if (!database.transaction()) {
+        errorString = QString("Failed to start migration transaction: %1").arg(database.lastError().text());
+        return false;
+    }
+    auto fail = [&database, &errorString](const QString& error) {
+        errorString = error;
+        database.rollback();
+        return false;
+    };
+
+    QSqlQuery query(database);
+    // Другая копия приложения могла начать миграцию одновременно
+    if (!query.exec(QString("SELECT pg_advisory_xact_lock(%1)").arg(MIGRATION_LOCK_KEY))) {
+        return fail(QString("Failed to lock schema migrations: %1").arg(query.lastError().text()));
+    }
+    if (!query.exec(R"(
+        CREATE TABLE IF NOT EXISTS schema_migrations (
+            version INTEGER PRIMARY KEY,
+            name TEXT NOT NULL,
+            applied_at TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP
+        )
+    )")) {
+        return fail(QString("Failed to create schema_migrations: %1").arg(query.lastError().text()));
+    }
+    // Под блокировкой список перечитывается: его могла изменить другая копия
+    QString error;
+    if (!appliedVersions(database, applied, error)) {
+        return fail(error);
+    }
+
+    QStringList appliedNames;
+    for (const Migration& migration : migrations) {
+        if (applied.contains(migration.version)) {
+            continue;
+        }
+        if (!apply(database, migration, error)) {
+            return fail(error);
+        }
+        appliedNames.append(migration.name);
+    }
+
+    if (!database.commit()) {
+        return fail(QString("Failed to commit schema migrations: %1").arg(database.lastError().text()));
+    }
+
+    qInfo() << "Applied" << appliedNames.size() << "schema migrations in" << timer.elapsed() << "ms:" << appliedNames;
+    return true;
+}
+
+bool SchemaMigrator::findMigrations(QList<Migration>& migrations, QString& errorString) {
+    static const QRegularExpression versionPattern("^(\\d+)_.+\\.sql$");
+
+    const QStringList files = QDir(MIGRATIONS_PATH).entryList(QStringList() << "*.sql", QDir::Files, QDir::Name);
+    for (const QString& file : files) {
+        const QRegularExpressionMatch match = versionPattern.match(file);
+        if (!match.hasMatch()) {
+            errorString = QString("Migration file name must start with a version: %1").arg(file);
+            return false;
+        }
+
+        Migration migration;
+        migration.version = match.captured(1).toInt();
+        migration.name = file;
+        migration.path = QDir(MIGRATIONS_PATH).filePath(file);
+        migrations.append(migration);
+    }
+
+    std::sort(migrations.begin(), migrations.end(), [](const Migration& left, const Migration& right) {
+        return left.version < right.version;
+    });
+    for (int i = 1; i < migrations.size(); ++i) {
+        if (migrations[i].version == migrations[i - 1].version) {
+            errorString = QString("Duplicate migration version %1: %2, %3")
+                              .arg(migrations[i].version)
+                              .arg(migrations[i - 1].name, migrations[i].name);
+            return false;
+        }
+    }
+
+    if (migrations.isEmpty()) {
+        errorString = QString("No schema migrations found in %1").arg(MIGRATIONS_PATH);
+        return false;
+    }
+    return true;
+}
+
+bool SchemaMigrator::appliedVersions(QSqlDatabase& database, QList<int>& versions, QString& errorString) {
+    versions.clear();
+
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT version FROM schema_migrations")) {
+        // 42P01 (undefined_table): база создана до миграций или пуста
+        if (query.lastError().nativeErrorCode() == "42P01") {
+            return true;
+        }
+        errorString = QString("Failed to read schema_migrations: %1").arg(query.lastError().text());
+        return false;
+    }
+
+    while (query.next()) {
+        versions.append(query.value(0).toInt());
+    }
+    return true;
+}
+
+bool SchemaMigrator::apply(QSqlDatabase& database, const Migration& migration, QString& errorString) {
+    QFile file(migration.path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        errorString = QString("Cannot open migration %1").arg(migration.path);
+        return false;
+    }
+    QTextStream in(&file);
+    const QStringList statements = splitStatements(in.readAll());
+    file.close();
+
+    QSqlQuery query(database);
+    for (const QString& statement : statements) {
+        if (!query.exec(statement)) {
+            errorString = QString("Migration %1 failed: %2").arg(migration.name, query.lastError().text());
+            qDebug() << "Statement:" << statement;
+            return false;
+        }
+    }
+
+    query.prepare("INSERT INTO schema_migrations (version, name) VALUES (?, ?)");
+    query.addBindValue(migration.version);
+    query.addBindValue(migration.name);
+    if (!query.exec()) {
+        errorString = QString("Failed to record migration %1: %2").arg(migration.name, query.lastError().text());
+        return false;
+    }
+
+    qDebug() << "Applied migration" << migration.name;
+    return true;
+}
+
+QStringList SchemaMigrator::splitStatements(const QString& script) {
+    static const QRegularExpression dollarTag("\\$(?:[A-Za-z_][A-Za-z_0-9]*)?\\$");
+
+    QStringList statements;
+    QString current;
+    auto flushStatement = [&]() {
+        const QString statement = current.trimmed();
+        if (!statement.isEmpty()) {
+            statements.append(statement);
+        }
+        current.clear();
+    };
+
+    const int length = int(script.size());
+    int i = 0;
+    while (i < length) {
+        const QChar c = script[i];
+        if (c == QLatin1Char('-') && i + 1 < length && script[i + 1] == QLatin1Char('-')) {
+            const int end = int(script.indexOf(QLatin1Char('\n'), i));
+            i = end < 0 ? length : end + 1;
+            current += QLatin1Char('\n');
+            continue;
+        }
+        if (c == QLatin1Char('\'')) {
+            // Кавычка внутри строки удваивается: 'it''s'
+            int end = i + 1;
+            for (;;) {
+                end = int(script.indexOf(QLatin1Char('\''), end));
+                if (end < 0) {
+                    end = length;
+                    break;
+                }
+                if (end + 1 < length && script[end + 1] == QLatin1Char('\'')) {
+                    end += 2;
+                    continue;
+                }
+                ++end;
+                break;
+            }
+            current += script.mid(i, end - i);
+            i = end;
+            continue;
+        }
+        if (c == QLatin1Char('$')) {
+            const QRegularExpressionMatch match = dollarTag.match(script, i, QRegularExpression::NormalMatch,
+                                                                  QRegularExpression::AnchorAtOffsetMatchOption);
+            if (match.hasMatch()) {
+                const QString tag = match.captured();
+                int end = int(script.indexOf(tag, i + tag.size()));
+                end = end < 0 ? length : end + int(tag.size());
+                current += script.mid(i, end - i);
+                i = end;
+                continue;
+            }
+        }
+        if (c == QLatin1Char(';')) {
+            flushStatement();
+        } else {
+            current += c;
+        }
+        ++i;
+    }
+    flushStatement();
+    return statements;
+}
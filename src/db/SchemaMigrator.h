@@ -0,0 +1,69 @@
+#ifndef SCHEMAMIGRATOR_H
+#define SCHEMAMIGRATOR_H
+
+#include <QList>
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Версионные миграции схемы БД.
+ *
+ * Миграции - файлы NNNN_описание.sql в ресурсе MIGRATIONS_PATH
+ * (data/migrations, см. resources.qrc), номер в начале имени - версия.
+ * Применённые версии записываются в таблицу schema_migrations.
+ *
+ * При запуске выполняется один запрос списка применённых версий; если
+ * новых миграций нет, больше ничего не делается. Иначе все недостающие
+ * миграции применяются по возрастанию версии в одной транзакции под
+ * рекомендательной блокировкой (одновременный запуск нескольких копий
+ * приложения применит их один раз): при ошибке схема не меняется.
+ */
+class SchemaMigrator
+{
+public:
+    /**
+     * @brief Применяет недостающие миграции.
+     * @param database Открытое соединение
+     * @param errorString Описание ошибки
+     * @return true если схема в актуальной версии
+     */
+    static bool migrate(QSqlDatabase& database, QString& errorString);
+
+    /**
+     * @brief Делит SQL-скрипт на операторы по ";" вне строк, комментариев
+     * и блоков $tag$ ... $tag$ (тела функций PL/pgSQL).
+     * Комментарии "--" отбрасываются.
+     */
+    static QStringList splitStatements(const QString& script);
+
+    static const QString MIGRATIONS_PATH;
+
+private:
+    struct Migration {
+        int version = 0;
+        QString name;
+        QString path;
+    };
+
+    /**
+     * @brief Находит миграции в ресурсах, упорядоченные по версии.
+     * @return false если имя файла не начинается с версии или версии повторяются
+     */
+    static bool findMigrations(QList<Migration>& migrations, QString& errorString);
+
+    /**
+     * @brief Читает применённые версии из schema_migrations.
+     * Отсутствие таблицы означает, что ни одна миграция не применена.
+     */
+    static bool appliedVersions(QSqlDatabase& database, QList<int>& versions, QString& errorString);
+
+    static bool apply(QSqlDatabase& database, const Migration& migration, QString& errorString);
+
+    // Ключ pg_advisory_xact_lock для применения миграций
+    static const qint64 MIGRATION_LOCK_KEY = 0x436f757273654442; // "CourseDB"
+
+    SchemaMigrator() = delete;
+};
+
+#endif // SCHEMAMIGRATOR_H
@@ -0,0 +1,101 @@
+#include "db/UserImport.h"
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+
+namespace {
+
+const int MIN_LOGIN_LENGTH = 3;
+const int MIN_PASSWORD_LENGTH = 4;
+
+} // namespace
+
+bool UserCsvReader::read(const QString& csvPath, QList<UserImportRow>& rows, UserImportReport& report) {
+    QFile file(csvPath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        report.errorString = QString("Cannot open CSV file: %1").arg(csvPath);
+        qDebug() << report.errorString;
+        return false;
+    }
+
+    QTextStream in(&file);
+    int lineNumber = 0;
+    QChar separator;
+
+    while (!in.atEnd()) {
+        const QString line = in.readLine();
+        ++lineNumber;
+        if (line.trimmed().isEmpty()) {
+            continue;
+        }
+
+        // Разделитель определяется по первой непустой строке
+        if (separator.isNull()) {
+            separator = line.count(';') > line.count(',') ? QChar(';') : QChar(',');
+        }
+
+        const QStringList fields = splitLine(line, separator);
+        if (rows.isEmpty() && report.totalRows == 0
+            && fields.value(0).trimmed().compare("login", Qt::CaseInsensitive) == 0) {
+            continue; // заголовок
+        }
+
+        ++report.totalRows;
+        UserImportRow row;
+        row.line = lineNumber;
+        row.login = fields.value(0).trimmed();
+        row.password = fields.value(1);
+        row.role = fields.value(2).trimmed().toLower();
+        if (row.role.isEmpty()) {
+            row.role = "student";
+        }
+
+        QString reason;
+        if (fields.size() < 2) {
+            reason = "ожидается login,password[,role]";
+        } else if (row.login.length() < MIN_LOGIN_LENGTH) {
+            reason = QString("логин короче %1 символов").arg(MIN_LOGIN_LENGTH);
+        } else if (row.password.length() < MIN_PASSWORD_LENGTH) {
+            reason = QString("пароль короче %1 символов").arg(MIN_PASSWORD_LENGTH);
+        } else if (row.role != "student" && row.role != "admin") {
+            reason = QString("неизвестная роль \"%1\"").arg(row.role);
+        }
+
+        if (!reason.isEmpty()) {
+            report.rejectedRows.append(QString("строка %1: %2").arg(lineNumber).arg(reason));
+            continue;
+        }
+        rows.append(row);
+    }
+
+    return true;
+}
+
+QStringList UserCsvReader::splitLine(const QString& line, QChar separator) {
+    QStringList fields;
+    QString field;
+    bool quoted = false;
+
+    for (int i = 0; i < line.size(); ++i) {
+        const QChar c = line[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                field += '"';
+                ++i;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                field += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == separator) {
+            fields.append(field);
+            field.clear();
+        } else {
+            field += c;
+        }
+    }
+    fields.append(field);
+    return fields;
+}
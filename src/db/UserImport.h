@@ -0,0 +1,60 @@
+#ifndef USERIMPORT_H
+#define USERIMPORT_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Строка CSV-файла с новым пользователем.
+ */
+struct UserImportRow {
+    int line = 0;      // номер строки в файле, для сообщений об ошибках
+    QString login;
+    QString password;
+    QString role;
+};
+
+/**
+ * @brief Итог массового импорта пользователей.
+ */
+struct UserImportReport {
+    int totalRows = 0;            // строк с данными в файле
+    int imported = 0;             // добавлено пользователей
+    QStringList duplicateLogins;  // логины, которые уже есть в БД или повторяются в файле
+    QStringList rejectedRows;     // строки, не прошедшие проверку, с причиной
+    bool cancelled = false;
+    qint64 elapsedMs = 0;
+    QString errorString;
+
+    bool isSuccess() const { return errorString.isEmpty() && !cancelled; }
+};
+
+/**
+ * @brief Чтение списка пользователей из CSV.
+ *
+ * Формат: login,password[,role] - по одному пользователю в строке,
+ * разделитель "," или ";", поля можно заключать в двойные кавычки.
+ * Первая строка считается заголовком, если её первое поле - "login".
+ * Роль по умолчанию - student. Строки с коротким логином или паролем
+ * и с неизвестной ролью попадают в rejectedRows отчёта.
+ */
+class UserCsvReader
+{
+public:
+    /**
+     * @brief Читает CSV-файл с пользователями.
+     * @param csvPath Путь к файлу
+     * @param rows Прошедшие проверку строки
+     * @param report Заполняются totalRows и rejectedRows
+     * @return false если файл не удалось открыть (ошибка в report.errorString)
+     */
+    static bool read(const QString& csvPath, QList<UserImportRow>& rows, UserImportReport& report);
+
+private:
+    static QStringList splitLine(const QString& line, QChar separator);
+
+    UserCsvReader() = delete;
+};
+
+#endif // USERIMPORT_H
@@ -0,0 +1,249 @@
+#include "db/UsersTableModel.h"
+#include <QDebug>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include "db/ConnectionPool.h"
+
+UsersTableModel::UsersTableModel(QObject* parent)
+    : QAbstractTableModel(parent)
+    , m_sortColumn(IdColumn)
+    , m_sortOrder(Qt::AscendingOrder)
+    , m_lastId(-1)
+    , m_atEnd(false) {
+    connect(&m_pageWatcher, &QFutureWatcherBase::finished, this, &UsersTableModel::onPageLoaded);
+    refresh();
+}
+
+int UsersTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : int(m_rows.size());
+}
+
+int UsersTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant UsersTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= m_rows.size() || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    const UserRow& row = m_rows[index.row()];
+    switch (index.column()) {
+    case IdColumn:
+        return row.id;
+    case LoginColumn:
+        return row.login;
+    case RoleColumn:
+        return row.role;
+    case CreatedAtColumn:
+        return row.createdAt;
+    default:
+        return QVariant();
+    }
+}
+
+QVariant UsersTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+    case IdColumn:
+        return "ID";
+    case LoginColumn:
+        return "Login";
+    case RoleColumn:
+        return "Role";
+    case CreatedAtColumn:
+        return "Created At";
+    default:
+        return QVariant();
+    }
+}
+
+bool UsersTableModel::canFetchMore(const QModelIndex& parent) const {
+    return !parent.isValid() && !m_atEnd && !isLoading();
+}
+
+void UsersTableModel::fetchMore(const QModelIndex& parent) {
+    if (parent.isValid() || m_atEnd || isLoading()) {
+        return;
+    }
+    startFetch();
+}
+
+void UsersTableModel::sort(int column, Qt::SortOrder order) {
+    if (column < 0 || column >= ColumnCount) {
+        return;
+    }
+    if (column == m_sortColumn && order == m_sortOrder) {
+        return;
+    }
+
+    m_sortColumn = column;
+    m_sortOrder = order;
+    refresh();
+}
+
+void UsersTableModel::setFilter(const QString& text) {
+    const QString filter = text.trimmed();
+    if (filter == m_filter) {
+        return;
+    }
+
+    m_filter = filter;
+    refresh();
+}
+
+QString UsersTableModel::filter() const {
+    return m_filter;
+}
+
+void UsersTableModel::refresh() {
+    // Результат прежнего запроса больше не нужен: он отменяется на сервере,
+    // а наблюдатель переключается на новый запрос
+    if (isLoading()) {
+        m_pageWatcher.cancel();
+    }
+
+    beginResetModel();
+    m_rows.clear();
+    m_lastKey = QVariant();
+    m_lastId = -1;
+    m_atEnd = false;
+    endResetModel();
+
+    startFetch();
+}
+
+bool UsersTableModel::isLoading() const {
+    return m_pageWatcher.isRunning();
+}
+
+void UsersTableModel::startFetch() {
+    PageRequest request;
+    request.filter = m_filter;
+    request.sortColumn = m_sortColumn;
+    request.sortOrder = m_sortOrder;
+    request.lastKey = m_lastKey;
+    request.lastId = m_lastId;
+
+    m_pageWatcher.setFuture(AsyncDatabase::getInstance().run<Page>([request](Page& page) {
+        return queryPage(request, page);
+    }));
+}
+
+void UsersTableModel::onPageLoaded() {
+    if (m_pageWatcher.isCanceled() || m_pageWatcher.future().resultCount() == 0) {
+        return;
+    }
+
+    const QueryResult<Page> result = m_pageWatcher.result();
+    if (!result.ok) {
+        m_lastError = result.value.errorString.isEmpty() ? result.errorString : result.value.errorString;
+        m_atEnd = true;
+        qWarning() << "Users model:" << m_lastError;
+        return;
+    }
+
+    const Page& page = result.value;
+    m_atEnd = page.rows.size() < PAGE_SIZE;
+    m_lastError.clear();
+    if (page.rows.isEmpty()) {
+        return;
+    }
+
+    m_lastKey = page.lastKey;
+    m_lastId = page.lastId;
+    beginInsertRows(QModelIndex(), int(m_rows.size()), int(m_rows.size() + page.rows.size()) - 1);
+    m_rows.append(page.rows);
+    endInsertRows();
+}
+
+QString UsersTableModel::lastError() const {
+    return m_lastError;
+}
+
+QString UsersTableModel::sortExpression(int column) {
+    switch (column) {
+    case LoginColumn:
+        return "login";
+    case RoleColumn:
+        return "role";
+    case CreatedAtColumn:
+        // NULL не сравнивается в ключе страницы, поэтому заменяется
+        return "COALESCE(created_at, TIMESTAMP 'epoch')";
+    default:
+        return "id";
+    }
+}
+
+bool UsersTableModel::queryPage(const PageRequest& request, Page& page) {
+    ConnectionPool::Lease lease;
+    if (!lease.isValid()) {
+        page.errorString = lease.errorString();
+        return false;
+    }
+
+    const bool descending = request.sortOrder == Qt::DescendingOrder;
+    const QString direction = descending ? "DESC" : "ASC";
+    const QString comparison = descending ? "<" : ">";
+    const QString key = sortExpression(request.sortColumn);
+    const bool byId = key == "id";
+    // Ключ страницы передаётся текстом и приводится обратно на сервере:
+    // QDateTime хранит миллисекунды, а created_at - микросекунды, и ключ,
+    // прошедший через QDateTime, повторял бы или пропускал строки на границе
+    const QString keyParameter = request.sortColumn == CreatedAtColumn ? "CAST(? AS timestamp)" : "?";
+
+    QStringList conditions;
+    if (!request.filter.isEmpty()) {
+        // Подстрока ищется по GIN-индексу pg_trgm (idx_users_login_trgm)
+        conditions.append("login ILIKE ?");
+    }
+    if (request.lastId != -1) {
+        conditions.append(byId ? QString("id %1 ?").arg(comparison)
+                               : QString("(%1, id) %2 (%3, ?)").arg(key, comparison, keyParameter));
+    }
+
+    QString sql = QString("SELECT id, login, role, created_at, CAST(%1 AS text) FROM users").arg(key);
+    if (!conditions.isEmpty()) {
+        sql += " WHERE " + conditions.join(" AND ");
+    }
+    sql += byId ? QString(" ORDER BY id %1").arg(direction)
+                : QString(" ORDER BY %1 %2, id %2").arg(key, direction);
+    sql += QString(" LIMIT %1").arg(PAGE_SIZE);
+
+    QSqlQuery query(lease.database());
+    query.setForwardOnly(true);
+    query.prepare(sql);
+    if (!request.filter.isEmpty()) {
+        // Символы шаблона LIKE в тексте поиска ищутся буквально
+        QString pattern = request.filter;
+        pattern.replace("\\", "\\\\").replace("%", "\\%").replace("_", "\\_");
+        query.addBindValue("%" + pattern + "%");
+    }
+    if (request.lastId != -1) {
+        if (!byId) {
+            query.addBindValue(request.lastKey);
+        }
+        query.addBindValue(request.lastId);
+    }
+
+    if (!query.exec()) {
+        page.errorString = QString("Failed to load users: %1").arg(query.lastError().text());
+        return false;
+    }
+
+    while (query.next()) {
+        UserRow row;
+        row.id = query.value(0).toInt();
+        row.login = query.value(1).toString();
+        row.role = query.value(2).toString();
+        row.createdAt = query.value(3).toDateTime();
+        page.lastKey = query.value(4).toString();
+        page.lastId = row.id;
+        page.rows.append(row);
+    }
+    return true;
+}
@@ -0,0 +1,140 @@
+#ifndef USERSTABLEMODEL_H
+#define USERSTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QDateTime>
+#include <QFutureWatcher>
+#include <QList>
+#include <QString>
+#include <QVariant>
+#include "db/AsyncDatabase.h"
+
+/**
+ * @brief Модель таблицы пользователей с постраничной загрузкой из БД.
+ *
+ * Строки подгружаются страницами по PAGE_SIZE по мере прокрутки
+ * (canFetchMore/fetchMore). Страницы выбираются по ключу (keyset):
+ * следующая страница начинается после последней загруженной пары
+ * (значение столбца сортировки, id), поэтому запрос не зависит от
+ * глубины прокрутки, в отличие от OFFSET.
+ *
+ * Сортировка и фильтр по логину выполняются в SQL; загружаются только
+ * отображаемые столбцы (хеш пароля не читается). Поиск подстроки
+ * (ILIKE '%text%') использует GIN-индекс pg_trgm по users.login.
+ *
+ * Страницы загружаются в потоке AsyncDatabase. Новый фильтр или
+ * сортировка отменяют незавершённую загрузку (PQcancel), поэтому
+ * в таблицу попадает только результат последнего запроса.
+ */
+class UsersTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        IdColumn = 0,
+        LoginColumn,
+        RoleColumn,
+        CreatedAtColumn,
+        ColumnCount
+    };
+
+    explicit UsersTableModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    /**
+     * @brief Сортирует на стороне сервера и загружает первую страницу заново.
+     */
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    /**
+     * @brief Оставляет пользователей, логин которых содержит text (без учёта регистра).
+     */
+    void setFilter(const QString& text);
+    QString filter() const;
+
+    /**
+     * @brief Сбрасывает загруженные строки и загружает первую страницу.
+     * Незавершённая загрузка отменяется.
+     */
+    void refresh();
+
+    /**
+     * @brief Выполняется ли загрузка страницы.
+     */
+    bool isLoading() const;
+
+    /**
+     * @brief Текст последней ошибки загрузки.
+     */
+    QString lastError() const;
+
+    static const int PAGE_SIZE = 200;
+
+private slots:
+    /**
+     * @brief Добавляет загруженную страницу в модель.
+     */
+    void onPageLoaded();
+
+private:
+    struct UserRow {
+        int id = -1;
+        QString login;
+        QString role;
+        QDateTime createdAt;
+    };
+
+    /**
+     * @brief Параметры загрузки страницы; копируются в поток БД.
+     */
+    struct PageRequest {
+        QString filter;
+        int sortColumn = IdColumn;
+        Qt::SortOrder sortOrder = Qt::AscendingOrder;
+        QVariant lastKey;
+        int lastId = -1;   // -1 - первая страница
+    };
+
+    struct Page {
+        QList<UserRow> rows;
+        QVariant lastKey;
+        int lastId = -1;
+        QString errorString;
+    };
+
+    /**
+     * @brief Запускает загрузку страницы после последней загруженной строки.
+     */
+    void startFetch();
+
+    /**
+     * @brief Выполняет запрос страницы. Вызывается в потоке БД.
+     * @return false при ошибке запроса (описание в page.errorString)
+     */
+    static bool queryPage(const PageRequest& request, Page& page);
+
+    /**
+     * @brief SQL-выражение ключа сортировки для столбца.
+     */
+    static QString sortExpression(int column);
+
+    QList<UserRow> m_rows;
+    QString m_filter;
+    int m_sortColumn;
+    Qt::SortOrder m_sortOrder;
+    QVariant m_lastKey;   // ключ сортировки последней загруженной строки (текстом, без потери точности)
+    int m_lastId;
+    bool m_atEnd;
+    QString m_lastError;
+    QFutureWatcher<QueryResult<Page>> m_pageWatcher;
+};
+
+#endif // USERSTABLEMODEL_H
@@ -3,12 +3,18 @@
 #include <QFile>
 #include <QDir>
 #include <QMessageBox>
+#include <QScopeGuard>
 #include <QStandardPaths>
+#include <QThreadPool>
 
 #include "core/CourseManager.h"
+#include "core/CourseCache.h"
+#include "core/CourseVerifier.h"
+#include "core/CourseFormat.h"
 #include "core/CryptoUtils.h"
 #include "core/AppSettings.h"
 #include "db/DatabaseManager.h"
+#include "db/ProgressWriter.h"
 #include "ui/LoginDialog.h"
 #include "ui/AdminWindow.h"
 #include "ui/StudentWindow.h"
@@ -18,31 +24,56 @@ bool initializeCourse() {
 
     const QString binaryWritePath = AppSettings::getCourseBinaryPath();
 
-    const QString jsonResourcePath = ":/course.json";
+    // Окна затем получают тот же снимок/представление из кэша, без повторного чтения файла
+    CourseCache& cache = CourseCache::getInstance();
 
-    Course course = CourseManager::loadCourseFromBinary(binaryWritePath, AppSettings::ENCRYPTION_KEY);
+    // Копия, сохранённая редактором, имеет приоритет над встроенным курсом
+    if (QFile::exists(binaryWritePath)) {
+        bool hasCourse = false;
+        const bool needsUpgrade = CourseFormat::readMagic(binaryWritePath) == CourseFormat::MAGIC_NUMBER_V1;
 
-    if (course.chapters.isEmpty()) {
-        qInfo() << "Binary course file not found at" << binaryWritePath << ". Creating from source...";
-
-        Course sourceCourse = CourseManager::loadCourseFromJSON(jsonResourcePath);
+        if (!needsUpgrade) {
+            // Проверяются только заголовок и CRC32C таблицы глав, главы не расшифровываются
+            hasCourse = CourseVerifier::quickCheck(binaryWritePath);
+        }
 
-        if (sourceCourse.chapters.isEmpty()) {
-            QMessageBox::critical(nullptr, "Критическая ошибка",
-                                  QString("Не удалось загрузить данные из внутреннего ресурса:\n%1\n\nПриложение повреждено.").arg(jsonResourcePath));
-            return false;
+        if (needsUpgrade) {
+            QSharedPointer<const Course> course = cache.course();
+            hasCourse = !course->chapters.isEmpty();
+
+            // Однократное преобразование в текущий формат с контрольными суммами
+            if (hasCourse) {
+                qInfo() << "Converting course file to current format:" << binaryWritePath;
+                if (CourseManager::saveCourseToBinary(*course, binaryWritePath, AppSettings::ENCRYPTION_KEY)) {
+                    cache.publish(course);
+                } else {
+                    qWarning() << "Failed to convert course file, keeping old format";
+                }
+            }
         }
 
-        if (!CourseManager::saveCourseToBinary(sourceCourse, binaryWritePath, AppSettings::ENCRYPTION_KEY)) {
-            QMessageBox::critical(nullptr, "Критическая ошибка",
-                                  QString("Не удалось сохранить файл курса в:\n%1").arg(binaryWritePath));
-            return false;
+        if (hasCourse) {
+            qInfo() << "Binary course file loaded successfully from" << binaryWritePath;
+            return true;
         }
-        qInfo() << "Course successfully created and saved to" << binaryWritePath;
-    } else {
-        qInfo() << "Binary course file loaded successfully from" << binaryWritePath;
+
+        // Повреждённая копия откладывается в сторону, курс читается из ресурса
+        const QString corruptedPath = binaryWritePath + ".corrupted";
+        qWarning() << "Course file is corrupted, moving it to" << corruptedPath << "and using embedded course";
+        QFile::remove(corruptedPath);
+        QFile::rename(binaryWritePath, corruptedPath);
+        cache.invalidate();
     }
 
+    // Встроенный курс скомпилирован при сборке: первый запуск не разбирает JSON и ничего не пишет
+    if (!CourseVerifier::quickCheck(AppSettings::EMBEDDED_COURSE_PATH)) {
+        QMessageBox::critical(nullptr, "Критическая ошибка",
+                              QString("Встроенный файл курса %1 отсутствует или повреждён.\n\nПриложение повреждено.")
+                                  .arg(AppSettings::EMBEDDED_COURSE_PATH));
+        return false;
+    }
+
+    qInfo() << "Using embedded course" << AppSettings::EMBEDDED_COURSE_PATH;
     return true;
 }
 
@@ -71,6 +102,15 @@ int main(int argc, char* argv[]) {
     }
     qDebug() << "Database initialized successfully";
 
+    // Прогресс, не записанный при прошлом завершении (БД была недоступна)
+    ProgressWriter::getInstance().restorePending();
+    // Остаток очереди прогресса записывается на любом пути выхода
+    const auto progressGuard = qScopeGuard([]() { ProgressWriter::getInstance().shutdown(); });
+
+    // Калибровка PBKDF2 занимает доли секунды - выполняем её в фоне,
+    // пока проверяется курс и открывается окно входа
+    QThreadPool::globalInstance()->start([]() { CryptoUtils::passwordIterations(); });
+
     if (!initializeCourse()) {
         return 1;
     }
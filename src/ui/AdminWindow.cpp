@@ -1,11 +1,14 @@
 #include "ui/AdminWindow.h"
 #include "db/DatabaseManager.h"
-#include "core/CourseManager.h"
+#include "core/CourseCache.h"
 #include "core/AppSettings.h" // ДОБАВЛЕНО
 #include <QDateTime>
+#include <QFileInfo>
+#include <QStandardPaths>
 
 AdminWindow::AdminWindow(QWidget* parent)
-    : QMainWindow(parent), m_currentChapterIndex(-1)
+    : QMainWindow(parent), m_reportProgress(nullptr), m_importProgress(nullptr), m_currentChapterIndex(-1)
+    , m_journal(AppSettings::getCourseBinaryPath(), AppSettings::ENCRYPTION_KEY)
 {
     setWindowTitle("Панель администратора - HTTP Proxy Course");
     setMinimumSize(900, 600);
@@ -52,6 +55,12 @@ void AdminWindow::setupStudentsTab()
         "QPushButton:hover { background-color: #F57C00; }");
     controlsLayout->addWidget(m_reportButton);
 
+    m_importButton = new QPushButton("Импорт из CSV", m_studentsTab);
+    m_importButton->setStyleSheet(
+        "QPushButton { background-color: #2196F3; color: white; padding: 8px 16px; border: none; border-radius: 4px; }"
+        "QPushButton:hover { background-color: #1976D2; }");
+    controlsLayout->addWidget(m_importButton);
+
     mainLayout->addLayout(controlsLayout);
 
     m_studentsTableView = new QTableView(m_studentsTab);
@@ -59,25 +68,27 @@ void AdminWindow::setupStudentsTab()
     m_studentsTableView->setSelectionBehavior(QAbstractItemView::SelectRows);
     m_studentsTableView->setSortingEnabled(true);
 
-    DatabaseManager& db = DatabaseManager::getInstance();
-    m_usersModel = db.getUsersModel();
-
-    if (m_usersModel) {
-        m_proxyModel = new QSortFilterProxyModel(this);
-        m_proxyModel->setSourceModel(m_usersModel);
-        m_proxyModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
-        m_proxyModel->setFilterKeyColumn(1);
-
-        m_studentsTableView->setModel(m_proxyModel);
-        m_studentsTableView->hideColumn(2);
-        m_studentsTableView->horizontalHeader()->setStretchLastSection(true);
-        m_studentsTableView->resizeColumnsToContents();
-    }
+    // Пользователи подгружаются страницами при прокрутке; сортировка
+    // по заголовку и поиск выполняются на сервере
+    m_usersModel = new UsersTableModel(this);
+    m_studentsTableView->setModel(m_usersModel);
+    m_studentsTableView->sortByColumn(UsersTableModel::IdColumn, Qt::AscendingOrder);
+    m_studentsTableView->horizontalHeader()->setStretchLastSection(true);
+    m_studentsTableView->resizeColumnsToContents();
 
     mainLayout->addWidget(m_studentsTableView);
 
+    m_searchTimer = new QTimer(this);
+    m_searchTimer->setSingleShot(true);
+    m_searchTimer->setInterval(SEARCH_DEBOUNCE_MS);
+    connect(m_searchTimer, &QTimer::timeout, this, &AdminWindow::applySearch);
+
     connect(m_searchLineEdit, &QLineEdit::textChanged, this, &AdminWindow::onSearchTextChanged);
+    connect(m_searchLineEdit, &QLineEdit::returnPressed, this, &AdminWindow::applySearch);
     connect(m_reportButton, &QPushButton::clicked, this, &AdminWindow::onGenerateReportClicked);
+    connect(&m_reportWatcher, &QFutureWatcherBase::finished, this, &AdminWindow::onReportFinished);
+    connect(m_importButton, &QPushButton::clicked, this, &AdminWindow::onImportUsersClicked);
+    connect(&m_importWatcher, &QFutureWatcherBase::finished, this, &AdminWindow::onImportFinished);
 }
 
 void AdminWindow::setupCourseEditorTab()
@@ -143,12 +154,9 @@ void AdminWindow::setupCourseEditorTab()
 
 void AdminWindow::loadCourseData()
 {
-    m_course = CourseManager::loadCourseFromBinary(
-        AppSettings::getCourseBinaryPath(),
-        AppSettings::ENCRYPTION_KEY
-        );
+    m_course = CourseCache::getInstance().course();
 
-    if (m_course.chapters.isEmpty()) {
+    if (m_course->chapters.isEmpty()) {
         QMessageBox::warning(
             this,
             "Ошибка",
@@ -159,8 +167,8 @@ void AdminWindow::loadCourseData()
     }
 
     m_chaptersListWidget->clear();
-    for (int i = 0; i < m_course.chapters.size(); ++i) {
-        const Chapter& chapter = m_course.chapters[i];
+    for (int i = 0; i < m_course->chapters.size(); ++i) {
+        const Chapter& chapter = m_course->chapters[i];
         m_chaptersListWidget->addItem(
             QString("Глава %1: %2").arg(i + 1).arg(chapter.title)
             );
@@ -171,103 +179,197 @@ void AdminWindow::loadCourseData()
 
 void AdminWindow::onSearchTextChanged(const QString& text)
 {
-    if (m_proxyModel) {
-        m_proxyModel->setFilterFixedString(text);
-    }
+    Q_UNUSED(text);
+    // Каждое нажатие откладывает поиск; запрос уходит после паузы в наборе
+    m_searchTimer->start();
+}
+
+void AdminWindow::applySearch()
+{
+    m_searchTimer->stop();
+    m_usersModel->setFilter(m_searchLineEdit->text());
 }
 
 void AdminWindow::onGenerateReportClicked()
 {
-    DatabaseManager& db = DatabaseManager::getInstance();
-
-    QString queryString = R"(
-        SELECT
-            u.login,
-            COUNT(sp.chapter_id) FILTER (WHERE sp.status = 'completed') AS completed_chapters,
-            MAX(sp.updated_at) AS last_activity
-        FROM
-            users u
-        LEFT JOIN
-            study_progress sp ON u.id = sp.user_id
-        WHERE
-            u.role = 'student'
-        GROUP BY
-            u.id, u.login
-        ORDER BY
-            completed_chapters DESC,
-            u.login;
-    )";
-
-    QSqlQuery query = db.executeSelectQuery(queryString);
-
-    if (!query.isActive()) {
-        QMessageBox::critical(this, "Ошибка", "Не удалось выполнить запрос к базе данных для отчета.");
+    if (m_reportWatcher.isRunning()) {
         return;
     }
 
-    QString reportContent;
-    reportContent += "=== ОТЧЕТ ПО УСПЕВАЕМОСТИ СТУДЕНТОВ ===\n";
-    reportContent += QString("Всего глав в курсе: %1\n").arg(m_course.chapters.size());
-    reportContent += QString("Дата создания отчета: %1\n\n")
-                         .arg(QDateTime::currentDateTime().toString("dd.MM.yyyy hh:mm:ss"));
-
-    reportContent += QString("%1 | %2 | %3\n")
-                         .arg("Логин студента", -20)
-                         .arg("Глав пройдено", -15)
-                         .arg("Последняя активность");
-    reportContent += QString(60, '-') + "\n";
-
-    while (query.next()) {
-        QString login = query.value(0).toString();
-        int completedCount = query.value(1).toInt();
-        QString lastActivity =
-            query.value(2).toDateTime().isNull()
-                ? "Нет активности"
-                : query.value(2).toDateTime().toString("dd.MM.yyyy hh:mm");
-
-        reportContent += QString("%1 | %2 | %3\n")
-                             .arg(login, -20)
-                             .arg(QString::number(completedCount), -15)
-                             .arg(lastActivity);
-    }
-
+    // Файл выбирается до запуска: строки пишутся в него по мере чтения курсора
     QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
     QString defaultFileName =
         defaultPath + QString("/Report_%1.txt")
                           .arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"));
 
+    const QString textFilter = "Text Files (*.txt)";
+    const QString csvFilter = "CSV Files (*.csv)";
+    const QString jsonFilter = "JSON Lines (*.jsonl)";
+    QString selectedFilter = textFilter;
     QString fileName = QFileDialog::getSaveFileName(
         this,
         "Сохранить отчет",
         defaultFileName,
-        "Text Files (*.txt);;All Files (*)"
+        QStringList{textFilter, csvFilter, jsonFilter, "All Files (*)"}.join(";;"),
+        &selectedFilter
         );
 
     if (fileName.isEmpty()) {
         return;
     }
 
-    QFile reportFile(fileName);
-    if (reportFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream out(&reportFile);
-        out << reportContent;
-        reportFile.close();
+    // Расширение файла важнее выбранного фильтра
+    ReportGenerator::Format format = ReportGenerator::formatForFile(fileName);
+    if (format == ReportGenerator::Format::Text && QFileInfo(fileName).suffix().isEmpty()) {
+        if (selectedFilter == csvFilter) {
+            format = ReportGenerator::Format::Csv;
+            fileName += ".csv";
+        } else if (selectedFilter == jsonFilter) {
+            format = ReportGenerator::Format::JsonLines;
+            fileName += ".jsonl";
+        }
+    }
+    m_reportFileName = fileName;
+
+    if (!m_reportProgress) {
+        m_reportProgress = new QProgressDialog("Формирование отчета...", "Отмена", 0, 0, this);
+        m_reportProgress->setWindowModality(Qt::WindowModal);
+        m_reportProgress->setMinimumDuration(500);
+        m_reportProgress->setAutoClose(false);
+        m_reportProgress->setAutoReset(false);
+        connect(&m_reportWatcher, &QFutureWatcherBase::progressRangeChanged,
+                m_reportProgress, &QProgressDialog::setRange);
+        connect(&m_reportWatcher, &QFutureWatcherBase::progressValueChanged,
+                m_reportProgress, &QProgressDialog::setValue);
+        connect(m_reportProgress, &QProgressDialog::canceled, &m_reportWatcher, &QFutureWatcherBase::cancel);
+    }
+    m_reportProgress->setRange(0, 0);
+    m_reportProgress->setValue(0);
 
-        QMessageBox::information(
-            this,
-            "Отчет создан",
-            QString("Отчет успешно сохранен в файл:\n%1").arg(fileName)
-            );
-    } else {
-        QMessageBox::critical(this, "Ошибка", "Не удалось сохранить отчет в файл.");
+    m_reportButton->setEnabled(false);
+    m_reportWatcher.setFuture(ReportGenerator::generate(fileName, format, m_course->chapters.size()));
+}
+
+void AdminWindow::onReportFinished()
+{
+    m_reportProgress->reset();
+    m_reportButton->setEnabled(true);
+
+    // После отмены итог не публикуется, а файл остаётся нетронутым
+    if (m_reportWatcher.isCanceled() || m_reportWatcher.future().resultCount() == 0) {
+        QMessageBox::information(this, "Отчет отменён", "Формирование отчета отменено, файл не создан.");
+        return;
     }
+
+    const ReportGenerator::Result result = m_reportWatcher.result();
+    if (!result.ok) {
+        QMessageBox::critical(this, "Ошибка",
+                              QString("Не удалось сформировать отчет.\n\nОшибка: %1").arg(result.errorString));
+        return;
+    }
+
+    QMessageBox::information(
+        this,
+        "Отчет создан",
+        QString("Отчет успешно сохранен в файл:\n%1\n\nСтудентов: %2\nВремя: %3 с")
+            .arg(m_reportFileName)
+            .arg(result.rows)
+            .arg(result.elapsedMs / 1000.0, 0, 'f', 1)
+        );
 }
 
+void AdminWindow::onImportUsersClicked()
+{
+    if (m_importWatcher.isRunning()) {
+        return;
+    }
+
+    const QString fileName = QFileDialog::getOpenFileName(
+        this,
+        "Импорт пользователей",
+        QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation),
+        "CSV Files (*.csv);;All Files (*)"
+        );
+
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    QList<UserImportRow> rows;
+    UserImportReport report;
+    if (!UserCsvReader::read(fileName, rows, report)) {
+        QMessageBox::critical(this, "Ошибка", QString("Не удалось прочитать файл:\n%1").arg(fileName));
+        return;
+    }
+
+    if (!m_importProgress) {
+        m_importProgress = new QProgressDialog("Хеширование паролей и загрузка пользователей...", "Отмена",
+                                               0, 0, this);
+        m_importProgress->setWindowModality(Qt::WindowModal);
+        m_importProgress->setMinimumDuration(0);
+        m_importProgress->setAutoClose(false);
+        m_importProgress->setAutoReset(false);
+        connect(&m_importWatcher, &QFutureWatcherBase::progressRangeChanged,
+                m_importProgress, &QProgressDialog::setRange);
+        connect(&m_importWatcher, &QFutureWatcherBase::progressValueChanged,
+                m_importProgress, &QProgressDialog::setValue);
+        connect(m_importProgress, &QProgressDialog::canceled, &m_importWatcher, &QFutureWatcherBase::cancel);
+    }
+    m_importProgress->setRange(0, rows.size());
+    m_importProgress->setValue(0);
+
+    // Хеширование и COPY идут в фоне, окно остаётся отзывчивым
+    m_importButton->setEnabled(false);
+    m_importWatcher.setFuture(AsyncDatabase::getInstance().importUsers(rows, report));
+}
+
+void AdminWindow::onImportFinished()
+{
+    m_importProgress->reset();
+    m_importButton->setEnabled(true);
+
+    if (m_importWatcher.isCanceled() || m_importWatcher.future().resultCount() == 0) {
+        QMessageBox::information(this, "Импорт отменён", "Импорт отменён, пользователи не добавлены.");
+        return;
+    }
+
+    const UserImportReport report = m_importWatcher.result();
+    if (report.cancelled) {
+        QMessageBox::information(this, "Импорт отменён", "Импорт отменён, пользователи не добавлены.");
+        return;
+    }
+    if (!report.isSuccess()) {
+        QMessageBox::critical(this, "Ошибка импорта",
+                              QString("Не удалось импортировать пользователей.\n\nОшибка: %1").arg(report.errorString));
+        return;
+    }
+
+    m_usersModel->refresh();
+
+    // В окне показываются только первые записи, полный список - в логе
+    const int shownLimit = 20;
+    QString summary = QString("Строк в файле: %1\nДобавлено: %2\nУже существуют: %3\nОтклонено: %4\nВремя: %5 с")
+                          .arg(report.totalRows)
+                          .arg(report.imported)
+                          .arg(report.duplicateLogins.size())
+                          .arg(report.rejectedRows.size())
+                          .arg(report.elapsedMs / 1000.0, 0, 'f', 1);
+    if (!report.duplicateLogins.isEmpty()) {
+        summary += "\n\nПовторяющиеся логины:\n" + report.duplicateLogins.mid(0, shownLimit).join(", ");
+        qDebug() << "Duplicate logins:" << report.duplicateLogins;
+    }
+    if (!report.rejectedRows.isEmpty()) {
+        summary += "\n\nОтклонённые строки:\n" + report.rejectedRows.mid(0, shownLimit).join("\n");
+        qDebug() << "Rejected rows:" << report.rejectedRows;
+    }
+
+    QMessageBox::information(this, "Импорт завершён", summary);
+}
 
 void AdminWindow::onChapterSelectionChanged()
 {
     m_currentChapterIndex = m_chaptersListWidget->currentRow();
-    if (m_currentChapterIndex >= 0 && m_currentChapterIndex < m_course.chapters.size()) {
+    if (m_currentChapterIndex >= 0 && m_currentChapterIndex < m_course->chapters.size()) {
         updateChapterContent();
         m_saveChangesButton->setEnabled(true);
     } else {
@@ -279,14 +381,14 @@ void AdminWindow::onChapterSelectionChanged()
 
 void AdminWindow::updateChapterContent()
 {
-    const Chapter& chapter = m_course.chapters[m_currentChapterIndex];
+    const Chapter& chapter = m_course->chapters[m_currentChapterIndex];
     m_chapterTitleEdit->setText(chapter.title);
     m_chapterContentEdit->setPlainText(chapter.content);
 }
 
 void AdminWindow::onSaveChangesClicked()
 {
-    if (m_currentChapterIndex < 0 || m_currentChapterIndex >= m_course.chapters.size()) {
+    if (m_currentChapterIndex < 0 || m_currentChapterIndex >= m_course->chapters.size()) {
         QMessageBox::warning(this, "Ошибка", "Не выбрана глава для сохранения.");
         return;
     }
@@ -297,7 +399,9 @@ void AdminWindow::onSaveChangesClicked()
         return;
     }
 
-    Chapter& chapter = m_course.chapters[m_currentChapterIndex];
+    // Снимок не меняется: правка идёт в копии, где отделяется только изменённая глава
+    QSharedPointer<Course> updated(new Course(*m_course));
+    Chapter& chapter = updated->chapters[m_currentChapterIndex];
     chapter.title = newTitle;
     chapter.content = m_chapterContentEdit->toPlainText();
 
@@ -305,10 +409,10 @@ void AdminWindow::onSaveChangesClicked()
         QString("Глава %1: %2").arg(m_currentChapterIndex + 1).arg(newTitle)
         );
 
-    if (CourseManager::saveCourseToBinary(
-            m_course,
-            AppSettings::getCourseBinaryPath(),
-            AppSettings::ENCRYPTION_KEY)) {
+    // Дописывается только изменённая глава, а не весь курс
+    if (m_journal.saveChapter(*updated, m_currentChapterIndex)) {
+        m_course = updated;
+        CourseCache::getInstance().publish(m_course);
 
         QMessageBox::information(
             this,
@@ -14,16 +14,22 @@
 #include <QSplitter>
 #include <QMessageBox>
 #include <QFileDialog>
-#include <QSqlTableModel>
-#include <QSortFilterProxyModel>
 #include <QHeaderView>
 #include <QFile>
 #include <QTextStream>
 #include <QSqlQuery>
 #include <QFileDialog>
 #include <QDateTime>
+#include <QTimer>
+#include <QProgressDialog>
 
 #include "models/Structures.h"
+#include "core/CourseJournal.h"
+#include "db/AsyncDatabase.h"
+#include "db/ReportGenerator.h"
+#include "db/UsersTableModel.h"
+#include <QSharedPointer>
+#include <QFutureWatcher>
 
 /**
  * @brief Главное окно администратора.
@@ -44,14 +50,40 @@ public:
 private slots:
     /**
      * @brief Обработчик изменения текста поиска студентов.
+     * Поиск откладывается до паузы в наборе (SEARCH_DEBOUNCE_MS).
      * @param text Новый текст для поиска
      */
     void onSearchTextChanged(const QString& text);
+
+    /**
+     * @brief Применяет текст поиска к модели пользователей.
+     * Фильтр выполняется в SQL в потоке БД (UsersTableModel).
+     */
+    void applySearch();
     
     /**
      * @brief Обработчик нажатия кнопки генерации отчета.
+     * Запрашивает файл и формат, затем запускает ReportGenerator
+     * в рабочем потоке с окном прогресса и кнопкой отмены.
      */
     void onGenerateReportClicked();
+
+    /**
+     * @brief Сообщает итог формирования отчета.
+     */
+    void onReportFinished();
+
+    /**
+     * @brief Обработчик массового импорта пользователей из CSV.
+     * Импорт выполняется в фоне (AsyncDatabase::importUsers) с окном
+     * прогресса и кнопкой отмены.
+     */
+    void onImportUsersClicked();
+
+    /**
+     * @brief Сообщает итог импорта пользователей.
+     */
+    void onImportFinished();
     
     /**
      * @brief Обработчик изменения выбранной главы в редакторе.
@@ -80,7 +112,7 @@ private:
     void setupCourseEditorTab();
     
     /**
-     * @brief Загружает данные курса из файла.
+     * @brief Получает снимок курса из CourseCache.
      */
     void loadCourseData();
     
@@ -97,8 +129,17 @@ private:
     QTableView* m_studentsTableView;
     QLineEdit* m_searchLineEdit;
     QPushButton* m_reportButton;
-    QSqlTableModel* m_usersModel;
-    QSortFilterProxyModel* m_proxyModel;
+    QPushButton* m_importButton;
+    UsersTableModel* m_usersModel;
+    QTimer* m_searchTimer;
+    QFutureWatcher<ReportGenerator::Result> m_reportWatcher;
+    QProgressDialog* m_reportProgress;
+    QString m_reportFileName;
+    QFutureWatcher<UserImportReport> m_importWatcher;
+    QProgressDialog* m_importProgress;
+
+    // Пауза в наборе, после которой выполняется поиск
+    static const int SEARCH_DEBOUNCE_MS = 300;
     
     // Виджеты вкладки редактора курса
     QWidget* m_courseEditorTab;
@@ -107,9 +148,10 @@ private:
     QTextEdit* m_chapterContentEdit;
     QPushButton* m_saveChangesButton;
     
-    // Данные курса
-    Course m_course;
+    // Данные курса: неизменяемый снимок из CourseCache
+    QSharedPointer<const Course> m_course;
     int m_currentChapterIndex;
+    CourseJournal m_journal;
 };
 
 #endif // ADMINWINDOW_H
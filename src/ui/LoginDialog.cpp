@@ -1,6 +1,5 @@
 #include "ui/LoginDialog.h"
-#include "db/DatabaseManager.h"
-#include "core/CryptoUtils.h"
+#include <QApplication>
 
 LoginDialog::LoginDialog(QWidget* parent)
     : QDialog(parent), m_userId(-1) {
@@ -56,6 +55,32 @@ void LoginDialog::setupUI() {
 
     // Обработка нажатия Enter для входа
     connect(m_passwordEdit, &QLineEdit::returnPressed, this, &LoginDialog::onLoginClicked);
+
+    // Результаты хеширования паролей из рабочего потока
+    connect(&m_verifyWatcher, &QFutureWatcher<CryptoUtils::PasswordCheck>::finished,
+            this, &LoginDialog::onPasswordVerified);
+    connect(&m_hashWatcher, &QFutureWatcher<QString>::finished, this, &LoginDialog::onPasswordHashed);
+
+    // Результаты запросов из потока БД
+    connect(&m_credentialsWatcher, &QFutureWatcherBase::finished, this, &LoginDialog::onCredentialsLoaded);
+    connect(&m_registerWatcher, &QFutureWatcherBase::finished, this, &LoginDialog::onUserRegistered);
+}
+
+bool LoginDialog::isBusy() const {
+    return m_verifyWatcher.isRunning() || m_hashWatcher.isRunning()
+        || m_credentialsWatcher.isRunning() || m_registerWatcher.isRunning();
+}
+
+void LoginDialog::setBusy(bool busy) {
+    m_loginEdit->setEnabled(!busy);
+    m_passwordEdit->setEnabled(!busy);
+    m_loginButton->setEnabled(!busy);
+    m_registerButton->setEnabled(!busy);
+    if (busy) {
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+    } else {
+        QApplication::restoreOverrideCursor();
+    }
 }
 
 QString LoginDialog::getRole() const {
@@ -75,14 +100,40 @@ void LoginDialog::onLoginClicked() {
         return;
     }
 
-    // Хеширование пароля для безопасности
-    QString passwordHash = CryptoUtils::hashPassword(password);
+    if (isBusy()) {
+        return;
+    }
+
+    m_pendingPassword = password;
+    setBusy(true);
+    m_credentialsWatcher.setFuture(AsyncDatabase::getInstance().getUserCredentials(login));
+}
+
+void LoginDialog::onCredentialsLoaded() {
+    const QString password = m_pendingPassword;
+    m_pendingPassword.clear();
+
+    const QueryResult<DatabaseManager::UserCredentials> result = m_credentialsWatcher.result();
+    if (!result.ok) {
+        setBusy(false);
+        QMessageBox::critical(this, "Ошибка авторизации",
+                              result.timedOut
+                                  ? QString("Сервер базы данных не ответил вовремя.\nПопробуйте ещё раз.")
+                                  : QString("Не удалось выполнить запрос к базе данных.\n\nОшибка: %1").arg(result.errorString));
+        return;
+    }
+
+    // Для несуществующего логина проверка всё равно выполняется
+    // (с пустым хешем), чтобы не выдавать его временем ответа
+    m_pendingCredentials = result.value;
+    m_verifyWatcher.setFuture(CryptoUtils::verifyPasswordAsync(password, m_pendingCredentials.passwordHash));
+}
 
-    // Аутентификация пользователя в базе данных
-    DatabaseManager& db = DatabaseManager::getInstance();
-    QPair<QString, int> authResult = db.authenticateUserWithId(login, passwordHash);
+void LoginDialog::onPasswordVerified() {
+    setBusy(false);
+    const CryptoUtils::PasswordCheck check = m_verifyWatcher.result();
 
-    if (authResult.first.isEmpty() || authResult.second == -1) {
+    if (!check.valid || m_pendingCredentials.id == -1) {
         QMessageBox::warning(this, "Ошибка авторизации",
                            "Неверный логин или пароль.\nПроверьте введенные данные и попробуйте снова.");
         m_passwordEdit->clear();
@@ -90,8 +141,14 @@ void LoginDialog::onLoginClicked() {
         return;
     }
 
-    m_userRole = authResult.first;
-    m_userId = authResult.second;
+    // Прозрачное обновление устаревшего хеша (SHA-256 или мало итераций)
+    // в фоне. Ошибка обновления не мешает входу: старый хеш остаётся рабочим.
+    if (!check.upgradedHash.isEmpty()) {
+        AsyncDatabase::getInstance().updatePasswordHash(m_pendingCredentials.id, check.upgradedHash);
+    }
+
+    m_userRole = m_pendingCredentials.role;
+    m_userId = m_pendingCredentials.id;
     accept();
 }
 
@@ -115,17 +172,37 @@ void LoginDialog::onRegisterClicked() {
         return;
     }
 
-    // Хеширование пароля перед сохранением
-    QString passwordHash = CryptoUtils::hashPassword(password);
+    if (isBusy()) {
+        return;
+    }
+
+    // Хеширование пароля перед сохранением выполняется в рабочем потоке
+    m_pendingLogin = login;
+    setBusy(true);
+    m_hashWatcher.setFuture(CryptoUtils::hashPasswordAsync(password));
+}
+
+void LoginDialog::onPasswordHashed() {
+    const QString passwordHash = m_hashWatcher.result();
+    if (passwordHash.isEmpty()) {
+        setBusy(false);
+        QMessageBox::critical(this, "Ошибка регистрации", "Не удалось вычислить хеш пароля.");
+        return;
+    }
 
     // Регистрация пользователя с ролью "student" по умолчанию
-    DatabaseManager& db = DatabaseManager::getInstance();
-    if (db.registerUser(login, passwordHash, "student")) {
+    m_registerWatcher.setFuture(AsyncDatabase::getInstance().registerUser(m_pendingLogin, passwordHash, "student"));
+}
+
+void LoginDialog::onUserRegistered() {
+    setBusy(false);
+    const QueryResult<bool> result = m_registerWatcher.result();
+    if (result.ok) {
         QMessageBox::information(this, "Успех",
-                               QString("Пользователь '%1' успешно зарегистрирован!\nТеперь вы можете войти в систему.").arg(login));
+                               QString("Пользователь '%1' успешно зарегистрирован!\nТеперь вы можете войти в систему.").arg(m_pendingLogin));
         m_passwordEdit->clear();
     } else {
         QMessageBox::critical(this, "Ошибка регистрации",
-                            QString("Не удалось зарегистрировать пользователя.\nВозможно, такой логин уже существует.\n\nОшибка: %1").arg(db.getLastError()));
+                            QString("Не удалось зарегистрировать пользователя.\nВозможно, такой логин уже существует.\n\nОшибка: %1").arg(result.errorString));
     }
 }
\ No newline at end of file
@@ -10,10 +10,16 @@
 #include <QLabel>
 #include <QMessageBox>
 #include <QString>
+#include <QFutureWatcher>
+#include "core/CryptoUtils.h"
+#include "db/AsyncDatabase.h"
+#include "db/DatabaseManager.h"
 
 /**
  * @brief Диалог авторизации пользователя.
  * Предоставляет интерфейс для входа в систему и регистрации новых пользователей.
+ * Запросы к БД (AsyncDatabase) и хеширование пароля (PBKDF2) выполняются
+ * в рабочих потоках, на это время кнопки диалога отключаются.
  */
 class LoginDialog : public QDialog
 {
@@ -49,17 +55,55 @@ private slots:
      */
     void onRegisterClicked();
 
+    /**
+     * @brief Запускает проверку пароля после получения учётных данных из БД.
+     */
+    void onCredentialsLoaded();
+
+    /**
+     * @brief Завершает вход после проверки пароля в рабочем потоке.
+     */
+    void onPasswordVerified();
+
+    /**
+     * @brief Завершает регистрацию после хеширования пароля в рабочем потоке.
+     */
+    void onPasswordHashed();
+
+    /**
+     * @brief Сообщает результат регистрации пользователя в БД.
+     */
+    void onUserRegistered();
+
 private:
     /**
      * @brief Настраивает пользовательский интерфейс диалога.
      */
     void setupUI();
+
+    /**
+     * @brief Проверяет, выполняется ли запрос или хеширование.
+     */
+    bool isBusy() const;
+
+    /**
+     * @brief Блокирует ввод на время запросов к БД и хеширования пароля.
+     */
+    void setBusy(bool busy);
     
     QLineEdit* m_loginEdit;
     QLineEdit* m_passwordEdit;
     QPushButton* m_loginButton;
     QPushButton* m_registerButton;
     
+    QFutureWatcher<CryptoUtils::PasswordCheck> m_verifyWatcher;
+    QFutureWatcher<QString> m_hashWatcher;
+    QFutureWatcher<QueryResult<DatabaseManager::UserCredentials>> m_credentialsWatcher;
+    QFutureWatcher<QueryResult<bool>> m_registerWatcher;
+    DatabaseManager::UserCredentials m_pendingCredentials;
+    QString m_pendingLogin;
+    QString m_pendingPassword;
+
     QString m_userRole;
     int m_userId;
 };
@@ -1,5 +1,5 @@
 #include "StudentWindow.h"
-#include "core/AppSettings.h"
+#include "core/CourseCache.h"
 
 StudentWindow::StudentWindow(int userId, QWidget* parent)
     : QMainWindow(parent)
@@ -16,6 +16,7 @@ StudentWindow::StudentWindow(int userId, QWidget* parent)
     , m_currentChapterIndex(0)
     , m_currentQuestionIndex(0)
     , m_errorsCount(0)
+    , m_progress(new ProgressCache(userId, this))
 {
     setWindowTitle("Система обучения HTTP Proxy - Студент");
     setMinimumSize(800, 600);
@@ -90,42 +91,37 @@ void StudentWindow::setupUI()
 
 void StudentWindow::loadCourse()
 {
-    m_course = CourseManager::loadCourseFromBinary(AppSettings::getCourseBinaryPath(), AppSettings::ENCRYPTION_KEY);
-
-    if (m_course.chapters.isEmpty()) {
+    // Файл уже открыт при запуске; главы расшифровываются по мере показа
+    m_course = CourseCache::getInstance().view();
+    if (!m_course) {
+        m_course.reset(new CourseView()); // пустое представление без глав
         QMessageBox::critical(this, "Ошибка", "Не удалось загрузить данные курса!");
         close();
         return;
     }
 
-    qDebug() << "Course loaded successfully with" << m_course.chapters.size() << "chapters";
+    qDebug() << "Course opened successfully with" << m_course->chapterCount() << "chapters";
 }
 
 void StudentWindow::initializeProgress()
 {
-    DatabaseManager& db = DatabaseManager::getInstance();
-    QPair<int, QString> lastProgress = db.getLastProgress(m_userId);
-    
-    int lastChapterId = lastProgress.first;
-    QString lastStatus = lastProgress.second;
-    
-    if (lastChapterId == -1) {
-        m_currentChapterIndex = 0;
-    } else {
-        if (lastStatus == "completed") {
-            m_currentChapterIndex = lastChapterId + 1;
-            if (m_currentChapterIndex >= m_course.chapters.size()) {
-                // Course completed
-                QMessageBox::information(this, "Поздравляем!", "Вы успешно завершили весь курс!");
-                m_currentChapterIndex = m_course.chapters.size() - 1;
-            }
-        } else {
-            m_currentChapterIndex = lastChapterId;
-        }
+    m_theoryBrowser->setHtml("<p>Загрузка прогресса...</p>");
+    m_takeTestButton->setEnabled(false);
+
+    connect(m_progress, &ProgressCache::loaded, this, &StudentWindow::onProgressLoaded);
+    m_progress->load();
+}
+
+void StudentWindow::onProgressLoaded(bool ok)
+{
+    if (!ok) {
+        qWarning() << "Starting without saved progress for user" << m_userId << ":" << m_progress->lastError();
     }
 
-    if (m_currentChapterIndex < 0 || m_currentChapterIndex >= m_course.chapters.size()) {
-        m_currentChapterIndex = 0;
+    bool courseCompleted = false;
+    m_currentChapterIndex = m_progress->resumeChapter(m_course->chapterCount(), &courseCompleted);
+    if (courseCompleted) {
+        QMessageBox::information(this, "Поздравляем!", "Вы успешно завершили весь курс!");
     }
     
     showTheoryPage();
@@ -133,26 +129,37 @@ void StudentWindow::initializeProgress()
 
 void StudentWindow::showTheoryPage()
 {
-    if (m_currentChapterIndex >= m_course.chapters.size()) {
+    if (m_currentChapterIndex >= m_course->chapterCount()) {
         QMessageBox::information(this, "Курс завершен", "Вы прошли все главы курса!");
         return;
     }
     
-    const Chapter& currentChapter = m_course.chapters[m_currentChapterIndex];
+    const QString chapterTitle = m_course->chapterTitle(m_currentChapterIndex);
+    const bool hasQuestions = m_course->questionCount(m_currentChapterIndex) > 0;
     
     setWindowTitle(QString("Система обучения HTTP Proxy - Глава %1: %2")
                    .arg(m_currentChapterIndex + 1)
-                   .arg(currentChapter.title));
+                   .arg(chapterTitle));
     
-    QString theoryContent = QString("<h2>Глава %1: %2</h2><br>%3")
+    // Статус главы берётся из кэша прогресса без запроса к БД
+    const QString chapterStatus = m_progress->status(m_currentChapterIndex);
+    QString statusLine;
+    if (chapterStatus == "completed") {
+        statusLine = "<p><i>Тест по главе пройден</i></p>";
+    } else if (chapterStatus == "fail") {
+        statusLine = "<p><i>Тест по главе не сдан, попробуйте еще раз</i></p>";
+    }
+
+    QString theoryContent = QString("<h2>Глава %1: %2</h2>%3<br>%4")
                            .arg(m_currentChapterIndex + 1)
-                           .arg(currentChapter.title)
-                           .arg(currentChapter.content);
+                           .arg(chapterTitle)
+                           .arg(statusLine)
+                           .arg(m_course->chapterContent(m_currentChapterIndex));
     
     m_theoryBrowser->setHtml(theoryContent);
     
-    m_takeTestButton->setEnabled(!currentChapter.questions.isEmpty());
-    if (currentChapter.questions.isEmpty()) {
+    m_takeTestButton->setEnabled(hasQuestions);
+    if (!hasQuestions) {
         m_takeTestButton->setText("Нет тестов для этой главы");
     } else {
         m_takeTestButton->setText("Пройти тест");
@@ -171,15 +178,15 @@ void StudentWindow::showTestPage()
 
 void StudentWindow::loadCurrentQuestion()
 {
-    if (m_currentChapterIndex >= m_course.chapters.size()) {
+    if (m_currentChapterIndex >= m_course->chapterCount()) {
         return;
     }
 
-    const Chapter& currentChapter = m_course.chapters[m_currentChapterIndex];
+    const int questionCount = m_course->questionCount(m_currentChapterIndex);
 
-    if (m_currentQuestionIndex >= currentChapter.questions.size()) {
-        DatabaseManager& db = DatabaseManager::getInstance();
-        db.saveProgress(m_userId, m_currentChapterIndex, 100, "completed");
+    if (m_currentQuestionIndex >= questionCount) {
+        // Кэш обновляется сразу, в БД запись уходит отложенно через ProgressWriter
+        m_progress->setProgress(m_currentChapterIndex, 100, "completed");
 
         QMessageBox::information(
             this,
@@ -192,8 +199,6 @@ void StudentWindow::loadCurrentQuestion()
         return;
     }
 
-    const Question& currentQuestion = currentChapter.questions[m_currentQuestionIndex];
-
     QWidget* answersWidget = m_testPage->findChild<QWidget*>("answersWidget");
     if (answersWidget) {
         if (QLayout* layout = answersWidget->layout()) {
@@ -210,8 +215,8 @@ void StudentWindow::loadCurrentQuestion()
 
     m_questionLabel->setText(QString("Вопрос %1 из %2:\n\n%3")
                                  .arg(m_currentQuestionIndex + 1)
-                                 .arg(currentChapter.questions.size())
-                                 .arg(currentQuestion.q_text));
+                                 .arg(questionCount)
+                                 .arg(m_course->questionText(m_currentChapterIndex, m_currentQuestionIndex)));
 
     if (answersWidget) {
         QVBoxLayout* answersLayout = qobject_cast<QVBoxLayout*>(answersWidget->layout());
@@ -219,8 +224,9 @@ void StudentWindow::loadCurrentQuestion()
             answersLayout = new QVBoxLayout(answersWidget);
         }
 
-        for (int i = 0; i < currentQuestion.options.size(); ++i) {
-            QRadioButton* radioButton = new QRadioButton(currentQuestion.options[i]);
+        const QStringList options = m_course->questionOptions(m_currentChapterIndex, m_currentQuestionIndex);
+        for (int i = 0; i < options.size(); ++i) {
+            QRadioButton* radioButton = new QRadioButton(options[i]);
             radioButton->setStyleSheet("font-size: 13px; margin-left: 15px;");
             m_answerButtons.append(radioButton);
             m_answerGroup->addButton(radioButton, i);
@@ -231,13 +237,11 @@ void StudentWindow::loadCurrentQuestion()
 
 void StudentWindow::onTakeTestClicked()
 {
-    if (m_currentChapterIndex >= m_course.chapters.size()) {
+    if (m_currentChapterIndex >= m_course->chapterCount()) {
         return;
     }
     
-    const Chapter& currentChapter = m_course.chapters[m_currentChapterIndex];
-    
-    if (currentChapter.questions.isEmpty()) {
+    if (m_course->questionCount(m_currentChapterIndex) == 0) {
         QMessageBox::information(this, "Нет тестов", "Для этой главы нет тестовых вопросов.");
         return;
     }
@@ -247,13 +251,11 @@ void StudentWindow::onTakeTestClicked()
 
 void StudentWindow::onAnswerClicked()
 {
-    if (m_currentChapterIndex >= m_course.chapters.size()) {
+    if (m_currentChapterIndex >= m_course->chapterCount()) {
         return;
     }
     
-    const Chapter& currentChapter = m_course.chapters[m_currentChapterIndex];
-    
-    if (m_currentQuestionIndex >= currentChapter.questions.size()) {
+    if (m_currentQuestionIndex >= m_course->questionCount(m_currentChapterIndex)) {
         return;
     }
     
@@ -263,8 +265,7 @@ void StudentWindow::onAnswerClicked()
         return;
     }
     
-    const Question& currentQuestion = currentChapter.questions[m_currentQuestionIndex];
-    bool isCorrect = (selectedAnswer == currentQuestion.correct_index);
+    bool isCorrect = (selectedAnswer == m_course->correctIndex(m_currentChapterIndex, m_currentQuestionIndex));
     
     processAnswer(isCorrect);
 }
@@ -282,8 +283,7 @@ void StudentWindow::processAnswer(bool isCorrect)
                            .arg(m_errorsCount));
         
         if (m_errorsCount >= 3) {
-            DatabaseManager& db = DatabaseManager::getInstance();
-            db.saveProgress(m_userId, m_currentChapterIndex, 0, "fail");
+            m_progress->setProgress(m_currentChapterIndex, 0, "fail");
             
             QMessageBox::critical(this, "Тест не пройден", 
                                 "Вы допустили 3 ошибки. Изучите теорию заново.");
@@ -310,10 +310,10 @@ void StudentWindow::moveToNextChapter()
 {
     m_currentChapterIndex++;
     
-    if (m_currentChapterIndex >= m_course.chapters.size()) {
+    if (m_currentChapterIndex >= m_course->chapterCount()) {
         QMessageBox::information(this, "Курс завершен!", 
                                "Поздравляем! Вы успешно завершили весь курс обучения HTTP Proxy!");
-        m_currentChapterIndex = m_course.chapters.size() - 1;
+        m_currentChapterIndex = m_course->chapterCount() - 1;
     }
     
     showTheoryPage();
@@ -14,8 +14,9 @@
 #include <QDebug>
 
 #include "../models/Structures.h"
-#include "../core/CourseManager.h"
-#include "../db/DatabaseManager.h"
+#include "../core/CourseView.h"
+#include <QSharedPointer>
+#include "../db/ProgressCache.h"
 
 /**
  * @brief Главное окно студента.
@@ -55,6 +56,12 @@ private slots:
      */
     void onBackToTheoryClicked();
 
+    /**
+     * @brief Выбирает текущую главу по прогрессу, загруженному в кэш.
+     * @param ok false, если прогресс не удалось загрузить
+     */
+    void onProgressLoaded(bool ok);
+
 private:
     /**
      * @brief Настраивает пользовательский интерфейс.
@@ -62,12 +69,13 @@ private:
     void setupUI();
     
     /**
-     * @brief Загружает данные курса из файла.
+     * @brief Получает представление курса из CourseCache; поля глав читаются по мере показа.
      */
     void loadCourse();
     
     /**
-     * @brief Инициализирует прогресс студента.
+     * @brief Загружает весь прогресс студента в ProgressCache одним запросом.
+     * До ответа кнопка теста недоступна.
      */
     void initializeProgress();
     
@@ -123,7 +131,8 @@ private:
     int m_currentChapterIndex;
     int m_currentQuestionIndex;
     int m_errorsCount;
-    Course m_course;
+    QSharedPointer<const CourseView> m_course; // общее представление из CourseCache
+    ProgressCache* m_progress; // прогресс по главам в памяти, запись через ProgressWriter
 };
 
 #endif // STUDENTWINDOW_H